@@ -0,0 +1,139 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <automaton/position_automaton.hpp>
+
+
+// Glushkov automaton simulated without subset construction: the set of
+// active positions is a bit mask of Words machine words (bit 0 is the
+// initial state), followpos of a whole mask is an OR of one precomputed
+// entry per non-zero byte of the mask (Navarro & Raffinot).
+template <size_t Words = 1>
+class BitParallelAutomaton {
+public:
+	// Positions of the expression that match a byte, end markers and empty leaves excluded
+	static constexpr size_t kMaxPositions = 64 * Words - 1;
+
+	// Throws std::invalid_argument if the expression has more than kMaxPositions positions
+	explicit BitParallelAutomaton(std::string_view expression)
+		: BitParallelAutomaton{PositionAutomaton{std::vector{std::string{expression}}}}
+	{
+	}
+
+	explicit BitParallelAutomaton(const PositionAutomaton& positions);
+
+	bool accept(std::string_view s) const noexcept;
+
+private:
+	using Mask = std::array<uint64_t, Words>;
+
+	static constexpr size_t kChunks = 8 * Words;
+
+	std::vector<Mask> follow_;         // [chunk * 256 + byte]: union of follow of the chunk's positions set in byte
+	std::array<Mask, 256> symbols_{};  // Positions matching a byte
+	Mask final_{};                     // Positions followed by an end marker
+
+	static void set_(Mask& mask, size_t bit) { mask[bit / 64] |= uint64_t{1} << (bit % 64); }
+};
+
+
+template <size_t Words>
+BitParallelAutomaton<Words>::BitParallelAutomaton(const PositionAutomaton& positions)
+	: follow_(kChunks * 256)
+{
+	// Position -> bit. End markers get no bit, nor do empty leaves, which match no byte
+	// and so could never be active
+	constexpr size_t kNoBit = SIZE_MAX;
+	std::vector<size_t> bit(positions.size(), kNoBit);
+	size_t bits = 1;
+	for (uint32_t p = 1; p < positions.size(); ++p) {
+		if (positions.endPattern(p) == PositionAutomaton::kNoPattern && positions.bytes(p).any()) {
+			bit[p] = bits++;
+		}
+	}
+	if (bits > kMaxPositions + 1) {
+		throw std::invalid_argument("[BitParallelAutomaton::BitParallelAutomaton] Expression has " + std::to_string(bits - 1) + " positions, at most " + std::to_string(kMaxPositions) + " fit");
+	}
+
+	// Follow mask of every bit
+	std::vector<Mask> follow(64 * Words);
+	auto add_follow = [&](size_t from, const Subset& to) {
+		for (auto q : to) {
+			if (positions.endPattern(q) != PositionAutomaton::kNoPattern) {
+				set_(final_, from);
+			} else if (bit[q] != kNoBit) {
+				set_(follow[from], bit[q]);
+			}
+		}
+	};
+
+	add_follow(0, positions.initial());
+	for (uint32_t p = 1; p < positions.size(); ++p) {
+		if (bit[p] != kNoBit) {
+			add_follow(bit[p], positions.follow(p));
+
+			const auto& bytes = positions.bytes(p);
+			for (size_t b = 0; b < 256; ++b) {
+				if (bytes[b]) {
+					set_(symbols_[b], bit[p]);
+				}
+			}
+		}
+	}
+
+	for (size_t chunk = 0; chunk < kChunks; ++chunk) {
+		for (size_t byte = 1; byte < 256; ++byte) {
+			auto& mask = follow_[chunk * 256 + byte];
+			for (size_t i = 0; i < 8; ++i) {
+				if ((byte >> i) & 1) {
+					for (size_t w = 0; w < Words; ++w) {
+						mask[w] |= follow[chunk * 8 + i][w];
+					}
+				}
+			}
+		}
+	}
+}
+
+template <size_t Words>
+bool BitParallelAutomaton<Words>::accept(std::string_view s) const noexcept {
+	Mask active{};
+	active[0] = 1;
+
+	for (auto c : s) {
+		Mask next{};
+		for (size_t chunk = 0; chunk < kChunks; ++chunk) {
+			if (const auto byte = (active[chunk / 8] >> (chunk % 8 * 8)) & 0xff; byte != 0) {
+				const auto& follow = follow_[chunk * 256 + byte];
+				for (size_t w = 0; w < Words; ++w) {
+					next[w] |= follow[w];
+				}
+			}
+		}
+
+		const auto& symbol = symbols_[static_cast<unsigned char>(c)];
+		uint64_t any = 0;
+		for (size_t w = 0; w < Words; ++w) {
+			active[w] = next[w] & symbol[w];
+			any |= active[w];
+		}
+
+		if (any == 0) {
+			return false;
+		}
+	}
+
+	for (size_t w = 0; w < Words; ++w) {
+		if (active[w] & final_[w]) {
+			return true;
+		}
+	}
+	return false;
+}
@@ -0,0 +1,39 @@
+#include <automaton/build_statistics.hpp>
+
+#include <algorithm>
+
+
+void BuildStatistics::addPhase(const std::string& name, double seconds) {
+	const auto it = std::find_if(phases.begin(), phases.end(), [&](auto&& phase) { return phase.name == name; });
+	if (it != phases.end()) {
+		it->seconds += seconds;
+	} else {
+		phases.push_back({name, seconds});
+	}
+}
+
+void BuildStatistics::write(JsonWriter& json) const {
+	json.beginObject();
+
+	json.key("phases_ms").beginObject();
+	for (auto&& phase : phases) {
+		json.key(phase.name).value(phase.seconds * 1e3);
+	}
+	json.endObject();
+
+	json.key("nfa_states").value(nfa_states);
+	json.key("dfa_states").value(dfa_states);
+	json.key("minimized_states").value(minimized_states);
+	json.key("epsilon_closures").value(epsilon_closures);
+	json.key("subset_hits").value(subset_hits);
+	json.key("subset_misses").value(subset_misses);
+	json.key("transitions").value(transitions);
+
+	json.endObject();
+}
+
+std::string BuildStatistics::toJson() const {
+	JsonWriter json;
+	write(json);
+	return json.str();
+}
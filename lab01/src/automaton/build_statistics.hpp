@@ -0,0 +1,76 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <utils/json_writer.hpp>
+
+
+// Where the time and memory of one automaton construction went. Collected
+// only when asked for, see BuildOptions
+struct BuildStatistics {
+	struct Phase {
+		std::string name;
+		double seconds = 0;
+	};
+
+	// In the order they ran, a phase that runs again adds to its time
+	std::vector<Phase> phases;
+
+	size_t nfa_states = 0;         // Positions of the regex or states of the determinized FA
+	size_t dfa_states = 0;         // Subsets found by subset construction
+	size_t minimized_states = 0;   // After the last minimization, 0 if none ran
+	size_t epsilon_closures = 0;   // λ-closures computed by subset construction
+	size_t subset_hits = 0;        // Interned subsets that were already known
+	size_t subset_misses = 0;      // Interned subsets that became new DFA states
+	size_t transitions = 0;        // (state, symbol) entries of the transition map built by subset construction
+
+	void addPhase(const std::string& name, double seconds);
+
+	void write(JsonWriter& json) const;
+	std::string toJson() const;
+};
+
+// Adds the time from construction (or the last next) to stop as a phase;
+// does nothing without statistics
+class PhaseTimer {
+public:
+	PhaseTimer(BuildStatistics* statistics, const char* name)
+		: statistics_{statistics}
+		, name_{name}
+	{
+		if (statistics_) {
+			start_ = std::chrono::steady_clock::now();
+		}
+	}
+
+	~PhaseTimer() { stop(); }
+
+	PhaseTimer(const PhaseTimer&) = delete;
+	PhaseTimer& operator=(const PhaseTimer&) = delete;
+
+	// Ends the current phase and starts the next one
+	void next(const char* name) {
+		if (!statistics_) {
+			return;
+		}
+		const auto now = std::chrono::steady_clock::now();
+		statistics_->addPhase(name_, std::chrono::duration<double>(now - start_).count());
+		name_ = name;
+		start_ = now;
+	}
+
+	void stop() {
+		if (statistics_) {
+			statistics_->addPhase(name_, std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count());
+			statistics_ = nullptr;
+		}
+	}
+
+private:
+	BuildStatistics* statistics_;
+	const char* name_;
+	std::chrono::steady_clock::time_point start_;
+};
@@ -0,0 +1,68 @@
+#include <automaton/byte_classes.hpp>
+
+#include <map>
+#include <stdexcept>
+
+
+ByteClasses ByteClasses::fromAutomaton(const FiniteAutomaton& fa) {
+	ByteClasses classes;
+
+	for (auto&& [from, map_symbol_to_states] : fa.transitions()) {
+		std::map<States, ByteSet> groups;
+		for (auto&& [symbol, to_states] : map_symbol_to_states) {
+			if (!to_states.empty()) {
+				groups[to_states].set(static_cast<unsigned char>(symbol));
+			}
+		}
+		for (auto&& [to_states, set] : groups) {
+			classes.split(set);
+		}
+	}
+
+	return classes;
+}
+
+void ByteClasses::split(const ByteSet& set) {
+	// Each class partially covered by set gets a new id for its part inside set
+	std::array<size_t, 256> inside = {};
+	std::array<size_t, 256> total = {};
+	for (size_t b = 0; b < 256; ++b) {
+		++total[map_[b]];
+		if (set[b]) {
+			++inside[map_[b]];
+		}
+	}
+
+	std::array<ClassId, 256> new_id = {};
+	const auto old_count = count_;
+	for (size_t id = 0; id < old_count; ++id) {
+		if (inside[id] != 0 && inside[id] != total[id]) {
+			new_id[id] = static_cast<ClassId>(count_++);
+		}
+	}
+
+	for (size_t b = 0; b < 256; ++b) {
+		if (set[b] && new_id[map_[b]] != 0) {
+			map_[b] = new_id[map_[b]];
+		}
+	}
+}
+
+ByteSet ByteClasses::members(ClassId id) const {
+	ByteSet set;
+	for (size_t b = 0; b < 256; ++b) {
+		if (map_[b] == id) {
+			set.set(b);
+		}
+	}
+	return set;
+}
+
+char ByteClasses::representative(ClassId id) const {
+	for (size_t b = 0; b < 256; ++b) {
+		if (map_[b] == id) {
+			return static_cast<char>(b);
+		}
+	}
+	throw std::out_of_range("[ByteClasses::representative] There is no such class: " + std::to_string(static_cast<unsigned>(id)));
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <array>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+
+#include <automaton/finite_automaton.hpp>
+
+
+// Partition of the 256 byte values into equivalence classes.
+// Bytes of one class are indistinguishable for every transition.
+class ByteClasses {
+public:
+	using ClassId = uint8_t;
+
+	// Single class containing all bytes
+	ByteClasses() = default;
+
+	// Bytes are equivalent iff they lead to the same states from every state of fa
+	static ByteClasses fromAutomaton(const FiniteAutomaton& fa);
+
+	// Refines partition so that set becomes a union of classes
+	void split(const ByteSet& set);
+
+	size_t count() const noexcept { return count_; }
+
+	ClassId classOf(char c) const noexcept { return map_[static_cast<unsigned char>(c)]; }
+	const std::array<ClassId, 256>& map() const noexcept { return map_; }
+
+	ByteSet members(ClassId id) const;
+	char representative(ClassId id) const;
+
+private:
+	std::array<ClassId, 256> map_ = {};
+	size_t count_ = 1;
+};
@@ -0,0 +1,667 @@
+#include <automaton/compiled_automaton.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+#include <automaton/subset_table.hpp>
+#include <utils/mapped_file.hpp>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+
+namespace {
+
+constexpr std::array<char, 8> kMagic = {'L', 'A', 'B', '0', '1', 'D', 'F', 'A'};
+constexpr uint32_t kFormatVersion = 1;
+constexpr uint32_t kByteOrderMark = 0x01020304;
+constexpr size_t kSectionAlignment = 64;
+
+// Image starts with this header, numbers are in the byte order of the writer
+struct ImageHeader {
+	std::array<char, 8> magic;
+	uint32_t version;
+	uint32_t byte_order;
+	uint64_t size;      // Whole image, header included
+	uint64_t checksum;  // Of everything after the header
+	uint32_t state_count;
+	uint32_t class_count;
+	uint32_t initial_state;
+	uint32_t pattern_count;
+	std::array<uint32_t, 4> reserved;
+};
+static_assert(sizeof(ImageHeader) == kSectionAlignment);
+
+// Section offsets follow from the header counts
+struct ImageLayout {
+	size_t class_map;
+	size_t table;
+	size_t accept_bitmap;
+	size_t accept_offsets;
+	size_t accept_patterns;
+	size_t size;
+};
+
+size_t sAlign(size_t offset) {
+	return (offset + kSectionAlignment - 1) / kSectionAlignment * kSectionAlignment;
+}
+
+ImageLayout sLayout(const ImageHeader& header) {
+	const size_t states = header.state_count;
+
+	ImageLayout layout = {};
+	layout.class_map = sizeof(ImageHeader);
+	layout.table = sAlign(layout.class_map + 256);
+	layout.accept_bitmap = sAlign(layout.table + states * header.class_count * sizeof(uint32_t));
+	layout.accept_offsets = sAlign(layout.accept_bitmap + (states + 63) / 64 * sizeof(uint64_t));
+	layout.accept_patterns = sAlign(layout.accept_offsets + (states + 1) * sizeof(uint32_t));
+	layout.size = sAlign(layout.accept_patterns + header.pattern_count * sizeof(uint32_t));
+	return layout;
+}
+
+// FNV-1a over 64-bit words with an extra shift so that high bits reach the low ones.
+// size is a multiple of 8
+uint64_t sChecksum(const char* data, size_t size) {
+	uint64_t hash = 0xcbf29ce484222325;
+	for (size_t i = 0; i < size; i += sizeof(uint64_t)) {
+		uint64_t word;
+		std::memcpy(&word, data + i, sizeof(word));
+		hash = (hash ^ word) * 0x100000001b3;
+		hash ^= hash >> 29;
+	}
+	return hash;
+}
+
+template <typename T>
+std::span<const T> sSection(std::string_view image, size_t offset, size_t count) {
+	return {reinterpret_cast<const T*>(image.data() + offset), count};
+}
+
+}  // namespace
+
+
+CompiledAutomaton::CompiledAutomaton(
+	const FiniteAutomaton& fa,
+	const AcceptPatterns& accept_patterns /* = {} */,
+	std::shared_ptr<const BuildStatistics> statistics /* = {} */
+)
+	: state_count_{fa.states().size() + 1}
+	, statistics_{std::move(statistics)}
+{
+	UMap<State, StateId> ids;
+
+	StateId id = kDeadState;
+	for (auto&& state : fa.states()) {
+		ids[state] = ++id;
+	}
+
+	const auto classes = ByteClasses::fromAutomaton(fa);
+	class_count_ = classes.count();
+	class_map_ = classes.map();
+
+	std::vector<StateId> table(state_count_ * class_count_, kDeadState);
+
+	for (auto&& [from, to_states] : fa.epsilonTransitions()) {
+		if (!to_states.empty()) {
+			throw std::invalid_argument("[CompiledAutomaton::CompiledAutomaton] FA has λ-transitions in state \"" + from + "\"");
+		}
+	}
+
+	for (auto&& [from, map_symbol_to_states] : fa.transitions()) {
+		const auto row = ids[from] * class_count_;
+		for (auto&& [symbol, to_states] : map_symbol_to_states) {
+			if (to_states.size() > 1) {
+				throw std::invalid_argument("[CompiledAutomaton::CompiledAutomaton] FA is not deterministic in state \"" + from + "\"");
+			}
+			if (!to_states.empty()) {
+				table[row + classes.classOf(symbol)] = ids[*to_states.begin()];
+			}
+		}
+	}
+
+	std::vector<const PatternIds*> patterns_of(state_count_, nullptr);
+	for (auto&& state : fa.accept_states()) {
+		const auto it = accept_patterns.find(state);
+		patterns_of[ids[state]] = it != accept_patterns.end() ? &it->second : &kDefaultPatterns_;
+	}
+	setTables_(std::move(table), patterns_of);
+
+	if (auto it = ids.find(fa.initial_state()); it != ids.end()) {
+		initial_state_ = it->second;
+	}
+}
+
+CompiledAutomaton::CompiledAutomaton(
+	const std::array<ByteClasses::ClassId, 256>& class_map,
+	size_t class_count,
+	std::vector<StateId> table,
+	StateId initial_state,
+	const std::vector<bool>& accepting
+)
+	: state_count_{accepting.size()}
+	, class_count_{class_count}
+	, initial_state_{initial_state}
+	, class_map_{class_map}
+{
+	std::vector<const PatternIds*> patterns_of(state_count_, nullptr);
+	for (size_t i = 0; i < state_count_; ++i) {
+		if (accepting[i]) {
+			patterns_of[i] = &kDefaultPatterns_;
+		}
+	}
+	setTables_(std::move(table), patterns_of);
+}
+
+void CompiledAutomaton::setTables_(std::vector<StateId> table, const std::vector<const PatternIds*>& patterns_of) {
+	auto tables = std::make_shared<Tables_>();
+	tables->table = std::move(table);
+	tables->accept_bitmap.assign((state_count_ + 63) / 64, 0);
+	tables->accept_offsets.assign(1, 0);
+
+	for (size_t i = 0; i < state_count_; ++i) {
+		if (patterns_of[i]) {
+			tables->accept_bitmap[i / 64] |= uint64_t{1} << (i % 64);
+			for (auto pattern : *patterns_of[i]) {
+				tables->accept_patterns.push_back(static_cast<uint32_t>(pattern));
+			}
+		}
+		tables->accept_offsets.push_back(static_cast<uint32_t>(tables->accept_patterns.size()));
+	}
+
+	table_ = tables->table;
+	accept_bitmap_ = tables->accept_bitmap;
+	accept_offsets_ = tables->accept_offsets;
+	accept_patterns_ = tables->accept_patterns;
+	storage_ = std::move(tables);
+}
+
+CompiledAutomaton CompiledAutomaton::reversed() const {
+	const auto k = class_count_;
+
+	// Reverse edges per class, the dead state is left out
+	std::vector<Subset> reverse(state_count_ * k);
+	Subset final_states;
+	for (StateId q = 1; q < state_count_; ++q) {
+		for (size_t c = 0; c < k; ++c) {
+			if (const auto to = table_[q * k + c]; to != kDeadState) {
+				reverse[to * k + c].push_back(q);
+			}
+		}
+		if (isAccepting(q)) {
+			final_states.push_back(q);
+		}
+	}
+
+	SubsetTable subsets;
+	subsets.intern({});
+	const auto initial = subsets.intern(final_states).first;
+
+	std::vector<StateId> table;
+	std::vector<bool> accepting;
+	for (StateId id = 0; id < subsets.size(); ++id) {
+		table.resize((id + 1) * k, kDeadState);
+		accepting.push_back(std::binary_search(subsets[id].begin(), subsets[id].end(), initial_state_));
+
+		if (id == kDeadState) {
+			continue;
+		}
+
+		for (size_t c = 0; c < k; ++c) {
+			Subset next;
+			for (auto q : subsets[id]) {
+				next.insert(next.end(), reverse[q * k + c].begin(), reverse[q * k + c].end());
+			}
+			std::sort(next.begin(), next.end());
+			next.erase(std::unique(next.begin(), next.end()), next.end());
+
+			table[id * k + c] = subsets.intern(std::move(next)).first;
+		}
+	}
+
+	return CompiledAutomaton{class_map_, class_count_, std::move(table), initial, accepting};
+}
+
+CompiledAutomaton CompiledAutomaton::unanchored() const {
+	const auto k = class_count_;
+
+	// The initial state is added back after every byte, the dead state is left out
+	const auto start = initial_state_ == kDeadState ? Subset{} : Subset{initial_state_};
+
+	SubsetTable subsets;
+	subsets.intern({});
+	const auto initial = subsets.intern(start).first;
+
+	std::vector<StateId> table;
+	std::vector<bool> accepting;
+	for (StateId id = 0; id < subsets.size(); ++id) {
+		table.resize((id + 1) * k, kDeadState);
+		accepting.push_back(std::any_of(subsets[id].begin(), subsets[id].end(), [&](auto q) { return isAccepting(q); }));
+
+		if (id == kDeadState) {
+			continue;
+		}
+
+		for (size_t c = 0; c < k; ++c) {
+			Subset next = start;
+			for (auto q : subsets[id]) {
+				if (const auto to = table_[q * k + c]; to != kDeadState) {
+					next.push_back(to);
+				}
+			}
+			std::sort(next.begin(), next.end());
+			next.erase(std::unique(next.begin(), next.end()), next.end());
+
+			table[id * k + c] = subsets.intern(std::move(next)).first;
+		}
+	}
+
+	return CompiledAutomaton{class_map_, class_count_, std::move(table), initial, accepting};
+}
+
+CompiledAutomaton CompiledAutomaton::prefixes() const {
+	return CompiledAutomaton{class_map_, class_count_, {table_.begin(), table_.end()}, initial_state_, liveStates()};
+}
+
+// Backward search from the accepting states
+std::vector<bool> CompiledAutomaton::liveStates() const {
+	const auto k = class_count_;
+
+	std::vector<std::vector<StateId>> predecessors(state_count_);
+	std::vector<StateId> queue;
+	std::vector<bool> live(state_count_, false);
+	for (StateId q = 0; q < state_count_; ++q) {
+		for (size_t c = 0; c < k; ++c) {
+			predecessors[table_[q * k + c]].push_back(q);
+		}
+		if (isAccepting(q)) {
+			live[q] = true;
+			queue.push_back(q);
+		}
+	}
+
+	for (size_t head = 0; head < queue.size(); ++head) {
+		for (auto q : predecessors[queue[head]]) {
+			if (!live[q]) {
+				live[q] = true;
+				queue.push_back(q);
+			}
+		}
+	}
+	return live;
+}
+
+CompiledAutomaton CompiledAutomaton::complement() const {
+	const auto k = class_count_;
+
+	std::vector<StateId> table(k, kDeadState);
+	table.reserve((state_count_ + 1) * k);
+	for (auto to : table_) {
+		table.push_back(to + 1);
+	}
+
+	std::vector<bool> accepting = {false};
+	for (StateId q = 0; q < state_count_; ++q) {
+		accepting.push_back(!isAccepting(q));
+	}
+
+	return CompiledAutomaton{class_map_, class_count_, std::move(table), initial_state_ + 1, accepting};
+}
+
+auto CompiledAutomaton::run(StateId state, std::string_view s) const noexcept -> StateId {
+	const auto* table = table_.data();
+	const auto* class_map = class_map_.data();
+	const auto class_count = class_count_;
+
+	for (auto c : s) {
+		state = table[state * class_count + class_map[static_cast<unsigned char>(c)]];
+	}
+
+	return state;
+}
+
+bool CompiledAutomaton::accept(std::string_view s) const noexcept {
+	return isAccepting(run(initial_state_, s));
+}
+
+auto CompiledAutomaton::runParallel(StateId state, std::string_view s, size_t threads /* = 0 */) const -> StateId {
+	if (threads == 0) {
+		threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+	}
+
+	const auto chunks = std::min(threads, s.size() / kMinParallelChunk);
+	if (chunks <= 1) {
+		return run(state, s);
+	}
+
+	const auto chunk_size = s.size() / chunks;
+	auto chunk = [&](size_t i) {
+		return s.substr(i * chunk_size, i + 1 == chunks ? std::string_view::npos : chunk_size);
+	};
+
+	std::vector<ChunkMapping_> mappings(chunks);
+	{
+		std::vector<std::jthread> workers;
+		for (size_t i = 1; i < chunks; ++i) {
+			workers.emplace_back([&, i] { mappings[i] = mapChunk_(chunk(i)); });
+		}
+		state = run(state, chunk(0));
+	}
+
+	for (size_t i = 1; i < chunks; ++i) {
+		const auto& mapping = mappings[i];
+		state = mapping.ends.empty() ? run(state, chunk(i)) : mapping.ends[mapping.slot[state]];
+	}
+
+	return state;
+}
+
+bool CompiledAutomaton::acceptParallel(std::string_view s, size_t threads /* = 0 */) const {
+	return isAccepting(runParallel(initial_state_, s, threads));
+}
+
+auto CompiledAutomaton::mapChunk_(std::string_view chunk) const -> ChunkMapping_ {
+	constexpr auto kNoLane = std::numeric_limits<uint32_t>::max();
+
+	ChunkMapping_ mapping;
+	auto& [slot, ends] = mapping;
+	slot.resize(state_count_);
+	std::iota(slot.begin(), slot.end(), 0);
+	ends.assign(slot.begin(), slot.end());
+
+	// Merges equal states after 1, 2, 4, ... bytes: the first byte alone leaves at most one
+	// state per distinct entry of a table column
+	std::vector<uint32_t> lane_of(state_count_, kNoLane);
+	std::vector<uint32_t> lane;
+	size_t offset = 0;
+	for (size_t step = 1; offset < std::min(chunk.size(), kConvergenceWindow) && ends.size() > kMaxSpeculativeStates; step *= 2) {
+		const auto piece = chunk.substr(offset, step);
+		offset += piece.size();
+
+		lane.resize(ends.size());
+		size_t distinct = 0;
+		for (size_t j = 0; j < ends.size(); ++j) {
+			const auto end = run(ends[j], piece);
+			if (lane_of[end] == kNoLane) {
+				lane_of[end] = static_cast<uint32_t>(distinct);
+				ends[distinct++] = end;
+			}
+			lane[j] = lane_of[end];
+		}
+		ends.resize(distinct);
+
+		for (auto end : ends) {
+			lane_of[end] = kNoLane;
+		}
+		for (auto& j : slot) {
+			j = lane[j];
+		}
+	}
+
+	if (ends.size() > kMaxSpeculativeStates) {
+		ends.clear();
+		return mapping;
+	}
+
+	// The few states left step together, their table loads overlap
+	const auto* table = table_.data();
+	const auto* class_map = class_map_.data();
+	const auto class_count = class_count_;
+	const auto lanes = ends.size();
+	std::array<StateId, kMaxSpeculativeStates> state = {};
+	std::copy(ends.begin(), ends.end(), state.begin());
+	for (auto c : chunk.substr(offset)) {
+		const auto column = class_map[static_cast<unsigned char>(c)];
+		for (size_t j = 0; j < lanes; ++j) {
+			state[j] = table[state[j] * class_count + column];
+		}
+	}
+	std::copy(state.begin(), state.begin() + static_cast<ptrdiff_t>(lanes), ends.begin());
+
+	return mapping;
+}
+
+void CompiledAutomaton::acceptBatch(std::span<const std::string_view> inputs, std::span<bool> results) const noexcept {
+	const auto* table = table_.data();
+	const auto* class_map = class_map_.data();
+	const auto class_count = class_count_;
+
+	// Each lane holds one input. All lanes step together until the shortest remainder is consumed,
+	// then finished lanes take the next pending inputs
+	std::array<size_t, kBatchLanes> input;
+	std::array<const char*, kBatchLanes> cursor;
+	std::array<const char*, kBatchLanes> end;
+	std::array<StateId, kBatchLanes> state;
+
+	size_t pending = 0;
+	auto take = [&](size_t lane) {
+		input[lane] = pending++;
+		cursor[lane] = inputs[input[lane]].data();
+		end[lane] = cursor[lane] + inputs[input[lane]].size();
+		state[lane] = initial_state_;
+	};
+
+	if (inputs.size() >= kBatchLanes) {
+		for (size_t lane = 0; lane < kBatchLanes; ++lane) {
+			take(lane);
+		}
+
+		while (true) {
+			auto steps = end[0] - cursor[0];
+			for (size_t lane = 1; lane < kBatchLanes; ++lane) {
+				steps = std::min(steps, end[lane] - cursor[lane]);
+			}
+
+#if defined(__AVX2__)
+			static_assert(kBatchLanes == 8);
+			if (steps != 0 && table_.size() <= static_cast<size_t>(std::numeric_limits<int32_t>::max())) {
+				const auto width = _mm256_set1_epi32(static_cast<int32_t>(class_count));
+				auto states = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(state.data()));
+				for (ptrdiff_t i = 0; i < steps; ++i) {
+					const auto classes = _mm256_setr_epi32(
+						class_map[static_cast<unsigned char>(cursor[0][i])], class_map[static_cast<unsigned char>(cursor[1][i])],
+						class_map[static_cast<unsigned char>(cursor[2][i])], class_map[static_cast<unsigned char>(cursor[3][i])],
+						class_map[static_cast<unsigned char>(cursor[4][i])], class_map[static_cast<unsigned char>(cursor[5][i])],
+						class_map[static_cast<unsigned char>(cursor[6][i])], class_map[static_cast<unsigned char>(cursor[7][i])]
+					);
+					const auto index = _mm256_add_epi32(_mm256_mullo_epi32(states, width), classes);
+					states = _mm256_i32gather_epi32(reinterpret_cast<const int*>(table), index, sizeof(StateId));
+				}
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(state.data()), states);
+				for (auto& c : cursor) {
+					c += steps;
+				}
+				steps = 0;
+			}
+#endif
+
+			if (steps != 0) {
+				// Local copies let the compiler keep the lanes' states in registers
+				auto lane_state = state;
+				const auto lane_cursor = cursor;
+				for (ptrdiff_t i = 0; i < steps; ++i) {
+#pragma GCC unroll 8
+					for (size_t lane = 0; lane < kBatchLanes; ++lane) {
+						const auto c = static_cast<unsigned char>(lane_cursor[lane][i]);
+						lane_state[lane] = table[lane_state[lane] * class_count + class_map[c]];
+					}
+				}
+				state = lane_state;
+				for (auto& c : cursor) {
+					c += steps;
+				}
+			}
+
+			bool exhausted = false;
+			for (size_t lane = 0; lane < kBatchLanes && !exhausted; ++lane) {
+				if (cursor[lane] == end[lane]) {
+					results[input[lane]] = isAccepting(state[lane]);
+					if (pending == inputs.size()) {
+						input[lane] = inputs.size();
+						exhausted = true;
+					} else {
+						take(lane);
+					}
+				}
+			}
+			if (exhausted) {
+				break;
+			}
+		}
+
+		// Not enough inputs left to fill all lanes
+		for (size_t lane = 0; lane < kBatchLanes; ++lane) {
+			if (input[lane] != inputs.size()) {
+				const auto rest = std::string_view{cursor[lane], static_cast<size_t>(end[lane] - cursor[lane])};
+				results[input[lane]] = isAccepting(run(state[lane], rest));
+			}
+		}
+	}
+
+	for (; pending < inputs.size(); ++pending) {
+		results[pending] = accept(inputs[pending]);
+	}
+}
+
+std::span<const uint32_t> CompiledAutomaton::match(std::string_view s) const noexcept {
+	return acceptPatterns(run(initial_state_, s));
+}
+
+CompiledAutomaton::Stream::Stream(const CompiledAutomaton& automaton) noexcept
+	: automaton_{&automaton}
+	, state_{automaton.initial_state_}
+{
+}
+
+void CompiledAutomaton::Stream::feed(std::string_view chunk) noexcept {
+	// Dead state is absorbing, the rest of the input cannot change the answer
+	if (state_ != kDeadState) {
+		state_ = automaton_->run(state_, chunk);
+	}
+}
+
+void CompiledAutomaton::Stream::feed(std::istream& stream, size_t buffer_size /* = 1 << 16 */) {
+	std::vector<char> buffer(buffer_size);
+	while (state_ != kDeadState && stream) {
+		stream.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+		feed(std::string_view{buffer.data(), static_cast<size_t>(stream.gcount())});
+	}
+}
+
+bool CompiledAutomaton::Stream::finish() noexcept {
+	const auto accepted = automaton_->isAccepting(state_);
+	state_ = automaton_->initial_state_;
+	return accepted;
+}
+
+void CompiledAutomaton::save(std::ostream& out) const {
+	ImageHeader header = {};
+	header.magic = kMagic;
+	header.version = kFormatVersion;
+	header.byte_order = kByteOrderMark;
+	header.state_count = static_cast<uint32_t>(state_count_);
+	header.class_count = static_cast<uint32_t>(class_count_);
+	header.initial_state = initial_state_;
+	header.pattern_count = static_cast<uint32_t>(accept_patterns_.size());
+
+	const auto layout = sLayout(header);
+	header.size = layout.size;
+
+	std::string image(layout.size, '\0');
+	auto copy = [&](size_t offset, const auto& section) {
+		if (!section.empty()) {
+			std::memcpy(image.data() + offset, section.data(), section.size() * sizeof(section[0]));
+		}
+	};
+	copy(layout.class_map, class_map_);
+	copy(layout.table, table_);
+	copy(layout.accept_bitmap, accept_bitmap_);
+	copy(layout.accept_offsets, accept_offsets_);
+	copy(layout.accept_patterns, accept_patterns_);
+
+	header.checksum = sChecksum(image.data() + sizeof(header), image.size() - sizeof(header));
+	std::memcpy(image.data(), &header, sizeof(header));
+
+	if (!out.write(image.data(), static_cast<std::streamsize>(image.size()))) {
+		throw std::runtime_error("[CompiledAutomaton::save] Cannot write image");
+	}
+}
+
+CompiledAutomaton CompiledAutomaton::load(const std::string& path, bool verify /* = true */) {
+	auto file = std::make_shared<const MappedFile>(path, MappedFile::Access::Random);
+	const auto image = file->view();
+	return fromImage(image, std::move(file), verify);
+}
+
+CompiledAutomaton CompiledAutomaton::fromImage(std::string_view image, std::shared_ptr<const void> owner /* = {} */, bool verify /* = true */) {
+	auto fail = [](const std::string& message) {
+		throw std::invalid_argument("[CompiledAutomaton::fromImage] " + message);
+	};
+
+	if (reinterpret_cast<uintptr_t>(image.data()) % alignof(uint64_t) != 0) {
+		fail("Image is not aligned");
+	}
+	if (image.size() < sizeof(ImageHeader)) {
+		fail("Image is too short");
+	}
+
+	ImageHeader header;
+	std::memcpy(&header, image.data(), sizeof(header));
+	if (header.magic != kMagic) {
+		fail("Not a compiled automaton");
+	}
+	if (header.byte_order != kByteOrderMark) {
+		fail("Image was written with another byte order");
+	}
+	if (header.version != kFormatVersion) {
+		fail("Unsupported format version " + std::to_string(header.version));
+	}
+	if (header.state_count == 0 || header.class_count == 0 || header.class_count > 256 || header.initial_state >= header.state_count) {
+		fail("Corrupted header");
+	}
+
+	const auto layout = sLayout(header);
+	if (header.size != layout.size || image.size() < layout.size) {
+		fail("Image size does not match its header");
+	}
+
+	CompiledAutomaton automaton;
+	automaton.state_count_ = header.state_count;
+	automaton.class_count_ = header.class_count;
+	automaton.initial_state_ = header.initial_state;
+	std::memcpy(automaton.class_map_.data(), image.data() + layout.class_map, automaton.class_map_.size());
+
+	automaton.table_ = sSection<StateId>(image, layout.table, automaton.state_count_ * automaton.class_count_);
+	automaton.accept_bitmap_ = sSection<uint64_t>(image, layout.accept_bitmap, (automaton.state_count_ + 63) / 64);
+	automaton.accept_offsets_ = sSection<uint32_t>(image, layout.accept_offsets, automaton.state_count_ + 1);
+	automaton.accept_patterns_ = sSection<uint32_t>(image, layout.accept_patterns, header.pattern_count);
+	automaton.storage_ = std::move(owner);
+
+	if (verify) {
+		if (sChecksum(image.data() + sizeof(header), layout.size - sizeof(header)) != header.checksum) {
+			fail("Checksum mismatch");
+		}
+
+		// A valid checksum of a hand-made image still must not lead out of the tables
+		auto out_of_range = [](auto&& section, size_t limit) {
+			return std::any_of(section.begin(), section.end(), [limit](auto x) { return x >= limit; });
+		};
+		if (out_of_range(automaton.class_map_, automaton.class_count_) || out_of_range(automaton.table_, automaton.state_count_)) {
+			fail("Transition leads out of the table");
+		}
+	}
+
+	// Checked even in trusted images: match reads accept_patterns_ through these offsets
+	const auto& offsets = automaton.accept_offsets_;
+	if (offsets.front() != 0 || offsets.back() != header.pattern_count || !std::is_sorted(offsets.begin(), offsets.end())) {
+		fail("Corrupted accept patterns");
+	}
+
+	return automaton;
+}
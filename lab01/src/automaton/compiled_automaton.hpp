@@ -0,0 +1,192 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <automaton/build_statistics.hpp>
+#include <automaton/byte_classes.hpp>
+#include <automaton/finite_automaton.hpp>
+
+
+// Immutable matcher frozen from a deterministic FiniteAutomaton.
+// States are dense integers, transitions are a flat row-major table with
+// one row per state and one column per byte equivalence class.
+// Tables are shared between copies and may live in a memory-mapped file.
+class CompiledAutomaton {
+public:
+	using StateId = uint32_t;
+
+	static constexpr StateId kDeadState = 0;
+
+	// Throws std::invalid_argument if fa is not deterministic.
+	// Accept states missing in accept_patterns accept pattern 0
+	explicit CompiledAutomaton(
+		const FiniteAutomaton& fa,
+		const AcceptPatterns& accept_patterns = {},
+		std::shared_ptr<const BuildStatistics> statistics = {}
+	);
+
+	StateId initialState() const noexcept { return initial_state_; }
+	size_t stateCount() const noexcept { return state_count_; }
+	size_t classCount() const noexcept { return class_count_; }
+
+	// How the automaton was built, nullptr unless it was compiled from a DFA collecting statistics
+	const BuildStatistics* statistics() const noexcept { return statistics_.get(); }
+
+	ByteClasses::ClassId classOf(char c) const noexcept { return class_map_[static_cast<unsigned char>(c)]; }
+
+	StateId next(StateId state, char c) const noexcept {
+		return table_[state * class_count_ + class_map_[static_cast<unsigned char>(c)]];
+	}
+
+	bool isAccepting(StateId state) const noexcept {
+		return (accept_bitmap_[state / 64] >> (state % 64)) & 1;
+	}
+
+	// Returns state reached from state after reading s
+	StateId run(StateId state, std::string_view s) const noexcept;
+
+	bool accept(std::string_view s) const noexcept;
+
+	// Same as run for huge inputs: s is split into chunks matched on threads threads (0 for one
+	// per hardware thread). Every chunk but the first is run from all states at once; these usually
+	// converge to a few distinct states within kConvergenceWindow bytes, which gives a small
+	// state-to-state mapping per chunk, and the mappings are composed in order. A chunk that does
+	// not converge is run again from its actual start state once that is known
+	StateId runParallel(StateId state, std::string_view s, size_t threads = 0) const;
+
+	bool acceptParallel(std::string_view s, size_t threads = 0) const;
+
+	static constexpr size_t kMinParallelChunk = size_t{1} << 20;
+	static constexpr size_t kConvergenceWindow = 1024;
+	static constexpr size_t kMaxSpeculativeStates = 8;
+
+	// Matches inputs[i] into results[i]. Inputs are stepped kBatchLanes at a time in lockstep
+	// so that their table loads overlap; built with AVX2 the lanes use a vector gather
+	void acceptBatch(std::span<const std::string_view> inputs, std::span<bool> results) const noexcept;
+
+	static constexpr size_t kBatchLanes = 8;
+
+	// DFA of Σ* \ L over all bytes. The table is complete, so only acceptance flips; a fresh
+	// unreachable state 0 stays dead and the old dead state becomes an accepting sink
+	CompiledAutomaton complement() const;
+
+	// DFA of reverse(L): read backwards from position j of a text, it accepts
+	// at every position i such that text[i, j) is in L
+	CompiledAutomaton reversed() const;
+
+	// DFA of Σ*·L: read from position i of a text, it accepts at every position j
+	// such that text[k, j) is in L for some k >= i
+	CompiledAutomaton unanchored() const;
+
+	// DFA of the prefixes of words of L: the same table, every live state accepts
+	CompiledAutomaton prefixes() const;
+
+	// States from which an accepting state can be reached
+	std::vector<bool> liveStates() const;
+
+	// Patterns accepted in state in ascending order, i.e. by priority
+	std::span<const uint32_t> acceptPatterns(StateId state) const noexcept {
+		return {accept_patterns_.data() + accept_offsets_[state], accept_patterns_.data() + accept_offsets_[state + 1]};
+	}
+
+	// Patterns matching the whole s, empty if none
+	std::span<const uint32_t> match(std::string_view s) const noexcept;
+
+	// Resumable matching of input that arrives in chunks
+	class Stream {
+	public:
+		explicit Stream(const CompiledAutomaton& automaton) noexcept;
+
+		void feed(std::string_view chunk) noexcept;
+
+		// Feeds everything left in stream reading it by buffer_size bytes
+		void feed(std::istream& stream, size_t buffer_size = 1 << 16);
+
+		// Returns true if input fed so far is accepted, then starts over
+		bool finish() noexcept;
+
+		StateId state() const noexcept { return state_; }
+
+	private:
+		const CompiledAutomaton* automaton_;
+		StateId state_;
+	};
+
+	Stream stream() const noexcept { return Stream{*this}; }
+
+	// Writes the binary image: a 64-byte header (magic, format version, byte order,
+	// sizes, checksum) followed by the class map, transition table, accept bitmap
+	// and accept patterns, each section aligned to 64 bytes.
+	// Throws std::runtime_error if writing fails
+	void save(std::ostream& out) const;
+
+	// Maps a file written by save and matches straight out of the mapping, so
+	// processes loading the same file share its pages. verify = false skips the
+	// checksum and table bounds checks and is only safe for trusted files; the
+	// accept pattern offsets are always checked.
+	// Throws std::system_error if the file cannot be mapped, std::invalid_argument if it is malformed
+	static CompiledAutomaton load(const std::string& path, bool verify = true);
+
+	// Same as load for an image already in memory. image must be 8-byte aligned
+	// and stay valid while owner or any copy of the result is alive
+	static CompiledAutomaton fromImage(std::string_view image, std::shared_ptr<const void> owner = {}, bool verify = true);
+
+private:
+	size_t state_count_ = 0;
+	size_t class_count_ = 0;
+	StateId initial_state_ = kDeadState;
+
+	std::array<ByteClasses::ClassId, 256> class_map_ = {};
+
+	// Owner of the memory the tables below point into: Tables_ or a mapped file
+	std::shared_ptr<const void> storage_;
+
+	std::span<const StateId> table_;
+	std::span<const uint64_t> accept_bitmap_;
+
+	// Accepted patterns of state i are accept_patterns_[accept_offsets_[i] .. accept_offsets_[i + 1])
+	std::span<const uint32_t> accept_offsets_;
+	std::span<const uint32_t> accept_patterns_;
+
+	std::shared_ptr<const BuildStatistics> statistics_;
+
+	struct Tables_ {
+		std::vector<StateId> table;
+		std::vector<uint64_t> accept_bitmap;
+		std::vector<uint32_t> accept_offsets;
+		std::vector<uint32_t> accept_patterns;
+	};
+
+	inline static const PatternIds kDefaultPatterns_ = {0};
+
+	// State 0 must be the dead state
+	CompiledAutomaton(
+		const std::array<ByteClasses::ClassId, 256>& class_map,
+		size_t class_count,
+		std::vector<StateId> table,
+		StateId initial_state,
+		const std::vector<bool>& accepting
+	);
+
+	CompiledAutomaton() = default;
+
+	// Start state q of a chunk ends in ends[slot[q]]; ends is empty if the chunk did not converge
+	struct ChunkMapping_ {
+		std::vector<uint32_t> slot;
+		std::vector<StateId> ends;
+	};
+
+	ChunkMapping_ mapChunk_(std::string_view chunk) const;
+
+	// Takes ownership of table and builds accept metadata from patterns_of
+	void setTables_(std::vector<StateId> table, const std::vector<const PatternIds*>& patterns_of);
+};
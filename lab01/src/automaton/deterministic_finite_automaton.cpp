@@ -1,166 +1,699 @@
 #include <automaton/deterministic_finite_automaton.hpp>
 
-#include <parser/abstract_syntax_tree.hpp>
-#include <parser/recursive_descent_parser.hpp>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <barrier>
+#include <limits>
+#include <map>
+#include <numeric>
+#include <optional>
+#include <span>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <automaton/byte_classes.hpp>
+#include <automaton/position_automaton.hpp>
+#include <automaton/subset_table.hpp>
 #include <utils/set_utils.hpp>
 
 
 namespace {
 
-States sMove(const FiniteAutomaton& fa, const States& T, Symbol a) {
-	States states;
-	for (auto&& s : T) {
-		SetUtils::append(states, fa.transition(s, a));
+using Built = std::tuple<FiniteAutomaton, AcceptPatterns, std::optional<BuildStatistics>>;
+
+std::optional<BuildStatistics> sStatistics(bool collect_statistics) {
+	return collect_statistics ? std::optional<BuildStatistics>{std::in_place} : std::nullopt;
+}
+
+// Number of (state, symbol) entries
+size_t sTransitionEntries(const Transitions& transitions) {
+	size_t count = 0;
+	for (auto&& [from, map_symbol_to_states] : transitions) {
+		count += map_symbol_to_states.size();
+	}
+	return count;
+}
+
+// Splits the alphabet into groups of symbols of the same class; the first symbol of a group represents it
+std::vector<std::vector<Symbol>> sGroupByClass(const Alphabet& alphabet, const ByteClasses& classes) {
+	std::vector<std::vector<Symbol>> groups(classes.count());
+	for (auto a : alphabet) {
+		groups[classes.classOf(a)].push_back(a);
+	}
+	std::erase_if(groups, [](auto&& group) { return group.empty(); });
+	return groups;
+}
+
+// Maps representative of each group to its index, other bytes to -1
+std::array<int, 256> sGroupIndex(const std::vector<std::vector<Symbol>>& groups) {
+	std::array<int, 256> group_of;
+	group_of.fill(-1);
+	for (size_t g = 0; g < groups.size(); ++g) {
+		group_of[static_cast<unsigned char>(groups[g].front())] = static_cast<int>(g);
+	}
+	return group_of;
+}
+
+// Names DFA state after the set of NFA state names, e.g. "{0, 1, 7}"
+State sSubsetName(const Subset& subset, const std::vector<State>& names) {
+	States set;
+	for (auto id : subset) {
+		set.insert(names[id]);
 	}
-	return states;
+	return SetUtils::toString(set);
+}
+
+State sSubsetName(const Subset& subset) {
+	return SetUtils::toString(Set<uint32_t>(subset.begin(), subset.end()));
+}
+
+size_t sThreads(const BuildOptions& options) {
+	return options.threads != 0 ? options.threads : std::max<size_t>(1, std::thread::hardware_concurrency());
 }
 
-States sLambdaClosure(const FiniteAutomaton& fa, const States& T) {
-	auto closure = T;
-	auto stack = T;
+// λ-closures of all states over dense ids, computed once. States on a λ-cycle form one strongly
+// connected component and share its closure; a closure is kept as the list of components it
+// reaches, each component lists its states
+class LambdaClosures {
+public:
+	explicit LambdaClosures(const std::vector<Subset>& lambda);
+
+	size_t componentCount() const { return member_offsets_.size() - 1; }
+	uint32_t componentOf(uint32_t state) const { return component_[state]; }
+
+	// Components λ-reachable from component, itself included
+	std::span<const uint32_t> reach(uint32_t component) const {
+		return {reach_.data() + reach_offsets_[component], reach_.data() + reach_offsets_[component + 1]};
+	}
+
+	std::span<const uint32_t> members(uint32_t component) const {
+		return {members_.data() + member_offsets_[component], members_.data() + member_offsets_[component + 1]};
+	}
+
+private:
+	std::vector<uint32_t> component_;
+	std::vector<uint32_t> members_;
+	std::vector<uint32_t> member_offsets_ = {0};
+	std::vector<uint32_t> reach_;
+	std::vector<uint32_t> reach_offsets_ = {0};
+};
+
+// Iterative Tarjan: components are completed in reverse topological order, so the reach of
+// every successor component is known by the time a component is completed
+LambdaClosures::LambdaClosures(const std::vector<Subset>& lambda) {
+	constexpr auto kUnvisited = std::numeric_limits<uint32_t>::max();
+
+	const auto n = lambda.size();
+	component_.assign(n, kUnvisited);
+	std::vector<uint32_t> index(n, kUnvisited);
+	std::vector<uint32_t> low(n);
+	std::vector<uint32_t> stack;
+	std::vector<std::pair<uint32_t, size_t>> calls;  // state and its next λ-edge
+	std::vector<uint32_t> seen;                       // by component, stamped with the component being completed
+	uint32_t next_index = 0;
+
+	auto visit = [&](uint32_t v) {
+		index[v] = low[v] = next_index++;
+		stack.push_back(v);
+		calls.emplace_back(v, 0);
+	};
+
+	for (uint32_t root = 0; root < n; ++root) {
+		if (index[root] != kUnvisited) {
+			continue;
+		}
 
-	while (!stack.empty()) {
-		auto t = SetUtils::popFirst(stack);
+		visit(root);
+		while (!calls.empty()) {
+			const auto v = calls.back().first;
+			if (auto& edge = calls.back().second; edge < lambda[v].size()) {
+				const auto w = lambda[v][edge++];
+				if (index[w] == kUnvisited) {
+					visit(w);
+				} else if (component_[w] == kUnvisited) {
+					low[v] = std::min(low[v], index[w]);
+				}
+				continue;
+			}
 
-		for (auto&& u : fa.transition(t, 'L')) {
-			if (!closure.contains(u)) {
-				closure.insert(u);
-				stack.insert(u);
+			calls.pop_back();
+			if (!calls.empty()) {
+				const auto parent = calls.back().first;
+				low[parent] = std::min(low[parent], low[v]);
 			}
+			if (low[v] != index[v]) {
+				continue;
+			}
+
+			const auto c = static_cast<uint32_t>(componentCount());
+			const auto first_member = members_.size();
+			uint32_t w;
+			do {
+				w = stack.back();
+				stack.pop_back();
+				component_[w] = c;
+				members_.push_back(w);
+			} while (w != v);
+			member_offsets_.push_back(static_cast<uint32_t>(members_.size()));
+
+			seen.push_back(c);
+			reach_.push_back(c);
+			for (auto i = first_member; i < members_.size(); ++i) {
+				for (auto u : lambda[members_[i]]) {
+					if (component_[u] == c) {
+						continue;
+					}
+					// By index, reach_ grows meanwhile
+					const auto successor = component_[u];
+					for (auto k = reach_offsets_[successor]; k < reach_offsets_[successor + 1]; ++k) {
+						if (const auto d = reach_[k]; seen[d] != c) {
+							seen[d] = c;
+							reach_.push_back(d);
+						}
+					}
+				}
+			}
+			reach_offsets_.push_back(static_cast<uint32_t>(reach_.size()));
 		}
 	}
-
-	return closure;
 }
 
-FiniteAutomaton sBuildDfaFromFa(const FiniteAutomaton& fa) {
-	auto initial_state = sLambdaClosure(fa, {fa.initial_state()});
-	auto initial_state_str = SetUtils::toString(initial_state);
-	States states = {initial_state_str};
+// λ-closure of subsets with its own scratch space, one per worker of subset construction
+class LambdaClosure {
+public:
+	explicit LambdaClosure(const LambdaClosures& closures)
+		: closures_{&closures}
+		, seen_(closures.componentCount(), 0)
+	{
+	}
 
-	States accept_states;
-	if (!SetUtils::intersection(initial_state, fa.accept_states()).empty()) {
-		accept_states.insert(initial_state_str);
+	Subset operator()(const Subset& T) {
+		++count_;
+		++stamp_;
+
+		Subset result;
+		for (auto t : T) {
+			for (auto c : closures_->reach(closures_->componentOf(t))) {
+				if (seen_[c] != stamp_) {
+					seen_[c] = stamp_;
+					const auto members = closures_->members(c);
+					result.insert(result.end(), members.begin(), members.end());
+				}
+			}
+		}
+
+		// Components are disjoint, so there are no duplicates
+		std::sort(result.begin(), result.end());
+		return result;
 	}
 
-	Transitions transitions;
+	size_t count() const { return count_; }
+
+private:
+	const LambdaClosures* closures_;
+	std::vector<uint32_t> seen_;
+	uint32_t stamp_ = 0;
+	size_t count_ = 0;
+};
+
+struct InternCounts {
+	size_t hits = 0;
+	size_t misses = 0;
+};
+
+// States a worker claims from the frontier at a time
+constexpr uint32_t kExpandChunk = 16;
+
+// Interns everything reachable from the subsets already in table: successor(worker, subset, g)
+// is the subset reached by group g, worker < threads tells apart the threads calling it.
+// Returns a row of target ids per table id.
+// With ConcurrentSubsetTable the frontier is expanded level by level of the BFS: workers claim
+// kExpandChunk states of the level from a shared cursor, so one that runs out of work takes
+// over what the others have not started yet. Between levels one thread publishes the new subsets
+template <typename Table, typename Successor>
+std::vector<std::vector<uint32_t>> sExpand(Table& table, size_t groups, size_t threads, Successor&& successor, InternCounts& counts) {
+	std::vector<std::vector<uint32_t>> dfa_moves;
+
+	if constexpr (std::is_same_v<Table, SubsetTable>) {
+		for (uint32_t T = 0; T < table.size(); ++T) {
+			dfa_moves.emplace_back(groups);
+
+			for (size_t g = 0; g < groups; ++g) {
+				const auto [id, inserted] = table.intern(successor(0, table[T], g));
+				dfa_moves[T][g] = id;
+				++(inserted ? counts.misses : counts.hits);
+			}
+		}
+	} else {
+		table.publish();
+
+		std::vector<InternCounts> worker_counts(threads);
+		std::atomic<uint32_t> cursor = 0;
+		auto level_end = static_cast<uint32_t>(table.size());
+		auto done = level_end == 0;
+		dfa_moves.resize(level_end);
+
+		std::barrier sync{static_cast<std::ptrdiff_t>(threads), [&]() noexcept {
+			table.publish();
+			cursor.store(level_end, std::memory_order_relaxed);
+			level_end = static_cast<uint32_t>(table.size());
+			dfa_moves.resize(level_end);
+			done = cursor.load(std::memory_order_relaxed) == level_end;
+		}};
+
+		auto work = [&](size_t worker) {
+			auto& [hits, misses] = worker_counts[worker];
+			while (!done) {
+				for (auto begin = cursor.fetch_add(kExpandChunk); begin < level_end; begin = cursor.fetch_add(kExpandChunk)) {
+					for (auto T = begin; T < std::min(begin + kExpandChunk, level_end); ++T) {
+						auto& row = dfa_moves[T];
+						row.resize(groups);
+						for (size_t g = 0; g < groups; ++g) {
+							const auto [id, inserted] = table.intern(successor(worker, table[T], g));
+							row[g] = id;
+							++(inserted ? misses : hits);
+						}
+					}
+				}
+				sync.arrive_and_wait();
+			}
+		};
 
-	std::set<States> non_visited;
-	non_visited.insert(initial_state);
+		{
+			std::vector<std::jthread> workers;
+			for (size_t worker = 1; worker < threads; ++worker) {
+				workers.emplace_back(work, worker);
+			}
+			work(0);
+		}
+
+		for (auto [hits, misses] : worker_counts) {
+			counts.hits += hits;
+			counts.misses += misses;
+		}
+	}
 
-	while (!non_visited.empty()) {
-		auto T = *non_visited.begin();
-		non_visited.erase(non_visited.begin());
+	return dfa_moves;
+}
+
+template <typename Table>
+Built sBuildDfaFromFa(const FiniteAutomaton& fa, const BuildOptions& options) {
+	auto statistics = sStatistics(options.collect_statistics);
+	const auto sink = statistics ? &*statistics : nullptr;
+	PhaseTimer timer{sink, "indexing"};
+
+	const auto groups = sGroupByClass(fa.alphabet(), ByteClasses::fromAutomaton(fa));
+
+	const auto group_of = sGroupIndex(groups);
+
+	// Intern NFA states as dense ids
+	const std::vector<State> names(fa.states().begin(), fa.states().end());
+	UMap<State, uint32_t> ids;
+	for (uint32_t i = 0; i < names.size(); ++i) {
+		ids[names[i]] = i;
+	}
 
-		for (auto a : fa.alphabet()) {
-			auto U = sLambdaClosure(fa, sMove(fa, T, a));
-			auto U_str = SetUtils::toString(U);
-			if (!states.contains(U_str)) {
-				states.insert(U_str);
-				if (!SetUtils::intersection(U, fa.accept_states()).empty()) {
-					accept_states.insert(U_str);
+	std::vector<std::vector<Subset>> moves(names.size(), std::vector<Subset>(groups.size()));
+	std::vector<Subset> lambda(names.size());
+	for (auto&& [from, map_symbol_to_states] : fa.transitions()) {
+		const auto i = ids.at(from);
+		for (auto&& [symbol, to_states] : map_symbol_to_states) {
+			if (auto g = group_of[static_cast<unsigned char>(symbol)]; g != -1) {
+				for (auto&& to : to_states) {
+					moves[i][static_cast<size_t>(g)].push_back(ids.at(to));
 				}
-				non_visited.insert(U);
 			}
-			transitions[SetUtils::toString(T)][a] = {U_str};
 		}
 	}
+	for (auto&& [from, to_states] : fa.epsilonTransitions()) {
+		for (auto&& to : to_states) {
+			lambda[ids.at(from)].push_back(ids.at(to));
+		}
+	}
+
+	std::vector<bool> accepting(names.size());
+	for (auto&& state : fa.accept_states()) {
+		accepting[ids.at(state)] = true;
+	}
+
+	timer.next("closures");
+
+	const auto closures = LambdaClosures{lambda};
+
+	timer.next("subset construction");
+
+	const auto threads = sThreads(options);
+	std::vector<LambdaClosure> lambda_closures(threads, LambdaClosure{closures});
+
+	Table table;
+	InternCounts counts = {.misses = 1};  // the initial subset
+
+	table.intern(lambda_closures[0]({ids.at(fa.initial_state())}));
+
+	const auto dfa_moves = sExpand(table, groups.size(), threads, [&](size_t worker, const Subset& T, size_t g) {
+		Subset move;
+		for (auto t : T) {
+			move.insert(move.end(), moves[t][g].begin(), moves[t][g].end());
+		}
+		return lambda_closures[worker](move);
+	}, counts);
+
+	timer.next("naming");
+
+	std::vector<State> dfa_names;
+	States states;
+	States accept_states;
+	for (uint32_t T = 0; T < table.size(); ++T) {
+		dfa_names.push_back(sSubsetName(table[T], names));
+		states.insert(dfa_names.back());
+		if (std::any_of(table[T].begin(), table[T].end(), [&](auto t) { return accepting[t]; })) {
+			accept_states.insert(dfa_names.back());
+		}
+	}
+
+	Transitions transitions;
+	for (uint32_t T = 0; T < table.size(); ++T) {
+		auto& map_symbol_to_states = transitions[dfa_names[T]];
+		for (size_t g = 0; g < groups.size(); ++g) {
+			for (auto a : groups[g]) {
+				map_symbol_to_states[a] = {dfa_names[dfa_moves[T][g]]};
+			}
+		}
+	}
+
+	const auto entries = sTransitionEntries(transitions);
 
 	auto result = FiniteAutomaton{
 		std::move(states),
 		fa.alphabet(),
 		std::move(transitions),
-		std::move(initial_state_str),
+		std::move(dfa_names.front()),
 		std::move(accept_states)
 	};
 
+	timer.next("pruning");
+
 	//result.deleteState("{}");
 	result.deleteUnreachableStates();
 
-	return result;
+	timer.stop();
+	if (statistics) {
+		statistics->nfa_states = names.size();
+		statistics->dfa_states = table.size();
+		for (auto&& lambda_closure : lambda_closures) {
+			statistics->epsilon_closures += lambda_closure.count();
+		}
+		statistics->subset_misses = counts.misses;
+		statistics->subset_hits = counts.hits;
+		statistics->transitions = entries;
+	}
+
+	return {std::move(result), {}, std::move(statistics)};
 }
 
-Alphabet sCalculateAlphabet(std::string_view expression) {
-	Alphabet alphabet;
+template <typename Table>
+Built sBuildDfaFromRegex(const std::vector<std::string>& expressions, const BuildOptions& options) {
+	auto statistics = sStatistics(options.collect_statistics);
+	const auto sink = statistics ? &*statistics : nullptr;
+	PhaseTimer timer{sink, "positions"};
+
+	const auto positions = PositionAutomaton{expressions};
+	const auto& classes = positions.classes();
+	const auto groups = sGroupByClass(positions.alphabet(), classes);
+
+	timer.next("subset construction");
+
+	Table table;
+	InternCounts counts = {.misses = 1};  // the initial subset
+
+	table.intern(positions.initial());
+
+	const auto dfa_moves = sExpand(table, groups.size(), sThreads(options), [&](size_t, const Subset& s, size_t g) {
+		return positions.move(s, classes.classOf(groups[g].front()));
+	}, counts);
 
-	for (auto c : expression) {
-		if (c != '(' && c != ')' && c != '|' && c != '*') {
-			alphabet.insert(c);
+	timer.next("naming");
+
+	std::vector<State> dfa_names;
+	States states;
+	States accept_states;
+	AcceptPatterns accept_patterns;
+	for (uint32_t s = 0; s < table.size(); ++s) {
+		dfa_names.push_back(sSubsetName(table[s]));
+		states.insert(dfa_names.back());
+		for (auto p : table[s]) {
+			if (auto pattern = positions.endPattern(p); pattern != PositionAutomaton::kNoPattern) {
+				accept_states.insert(dfa_names.back());
+				accept_patterns[dfa_names.back()].insert(static_cast<size_t>(pattern));
+			}
 		}
 	}
 
-	return alphabet;
+	Transitions transitions;
+	for (uint32_t s = 0; s < table.size(); ++s) {
+		auto& map_symbol_to_states = transitions[dfa_names[s]];
+		for (size_t g = 0; g < groups.size(); ++g) {
+			for (auto b : groups[g]) {
+				map_symbol_to_states[b] = {dfa_names[dfa_moves[s][g]]};
+			}
+		}
+	}
+
+	const auto entries = sTransitionEntries(transitions);
+
+	auto dfa = FiniteAutomaton{
+		std::move(states),
+		positions.alphabet(),
+		std::move(transitions),
+		std::move(dfa_names.front()),
+		std::move(accept_states),
+	};
+
+	timer.stop();
+	if (statistics) {
+		// Positions are numbered from 1, end markers of the expressions are positions too
+		statistics->nfa_states = positions.size() - 1;
+		statistics->dfa_states = table.size();
+		statistics->subset_misses = counts.misses;
+		statistics->subset_hits = counts.hits;
+		statistics->transitions = entries;
+	}
+
+	return {std::move(dfa), std::move(accept_patterns), std::move(statistics)};
 }
 
-FiniteAutomaton sBuildDfaFromRegex(std::string_view expression) {
-	auto alphabet = sCalculateAlphabet(expression);
+// Hopcroft's partition refinement over dense state ids; the extra last state is a dead sink.
+// States accepting different patterns start in different blocks
+std::pair<FiniteAutomaton, AcceptPatterns> sMinimize(const FiniteAutomaton& dfa, const AcceptPatterns& accept_patterns) {
+	const auto groups = sGroupByClass(dfa.alphabet(), ByteClasses::fromAutomaton(dfa));
+	const auto group_of = sGroupIndex(groups);
+	const auto k = groups.size();
+
+	const std::vector<State> names(dfa.states().begin(), dfa.states().end());
+	UMap<State, uint32_t> ids;
+	for (uint32_t i = 0; i < names.size(); ++i) {
+		ids[names[i]] = i;
+	}
 
-	auto root = RecursiveDescentParser{}.parse("(" + std::string{expression} + ")#");
-	auto ast = AbstractSyntaxTree{root};
+	const auto n = static_cast<uint32_t>(names.size() + 1);
+	const auto dead = n - 1;
 
-	auto& leaf_to_index = ast.leafToIndex();
-	auto& index_to_leaf = ast.indexToLeaf();
-	auto& first_pos = ast.firstPos();
-	auto& follow_pos = ast.followPos();
+	std::vector<uint32_t> delta(n * k, dead);
+	for (auto&& [from, map_symbol_to_states] : dfa.transitions()) {
+		for (auto&& [symbol, to_states] : map_symbol_to_states) {
+			if (auto g = group_of[static_cast<unsigned char>(symbol)]; g != -1 && !to_states.empty()) {
+				delta[ids.at(from) * k + static_cast<size_t>(g)] = ids.at(*to_states.begin());
+			}
+		}
+	}
 
-	auto* accept_node = ast.findLeaf('#');
-	auto accept_node_index = leaf_to_index[accept_node];
+	std::vector<std::vector<uint32_t>> inverse(k * n);
+	for (uint32_t q = 0; q < n; ++q) {
+		for (size_t g = 0; g < k; ++g) {
+			inverse[g * n + delta[q * k + g]].push_back(q);
+		}
+	}
 
-	auto initial_state = SetUtils::toString(first_pos[root]);
-	auto states = States{initial_state};
+	// Blocks are contiguous ranges [first, end) of elems, marked elements are moved to the front of a block
+	std::vector<uint32_t> elems(n);
+	std::vector<uint32_t> loc(n);
+	std::vector<uint32_t> block_of(n);
+	std::vector<uint32_t> first;
+	std::vector<uint32_t> end;
+	std::vector<uint32_t> marked;
+
+	// Label 0 is "not accepting", others enumerate distinct sets of accepted patterns
+	std::vector<uint32_t> label(n, 0);
+	std::vector<const PatternIds*> label_patterns = {nullptr};
+	std::map<PatternIds, uint32_t> label_of;
+	const PatternIds default_patterns = {0};
+	for (auto&& state : dfa.accept_states()) {
+		const auto it = accept_patterns.find(state);
+		const auto& patterns = it != accept_patterns.end() ? it->second : default_patterns;
+		auto [label_it, inserted] = label_of.try_emplace(patterns, static_cast<uint32_t>(label_patterns.size()));
+		if (inserted) {
+			label_patterns.push_back(&label_it->first);
+		}
+		label[ids.at(state)] = label_it->second;
+	}
 
-	States accept_states;
-	if (first_pos[root].contains(accept_node_index)) {
-		accept_states = states;
+	std::iota(elems.begin(), elems.end(), 0);
+	std::stable_sort(elems.begin(), elems.end(), [&](auto p, auto q) { return label[p] < label[q]; });
+	for (uint32_t i = 0; i < n; ++i) {
+		if (i == 0 || label[elems[i]] != label[elems[i - 1]]) {
+			first.push_back(i);
+			end.push_back(i);
+			marked.push_back(0);
+		}
+		++end.back();
+		block_of[elems[i]] = static_cast<uint32_t>(first.size() - 1);
+		loc[elems[i]] = i;
 	}
 
-	Transitions transitions;
+	std::vector<std::pair<uint32_t, size_t>> work;
+	std::vector<char> in_work(first.size() * k, 1);
+	for (uint32_t block = 0; block < first.size(); ++block) {
+		for (size_t g = 0; g < k; ++g) {
+			work.emplace_back(block, g);
+		}
+	}
 
-	std::set<std::set<size_t>> non_visited;
-	non_visited.insert(first_pos[root]);
+	std::vector<uint32_t> splitter;
+	std::vector<uint32_t> touched;
+	while (!work.empty()) {
+		auto [B, a] = work.back();
+		work.pop_back();
+		in_work[B * k + a] = 0;
+
+		splitter.assign(elems.begin() + first[B], elems.begin() + end[B]);
+		for (auto q : splitter) {
+			for (auto p : inverse[a * n + q]) {
+				const auto Y = block_of[p];
+				const auto m = first[Y] + marked[Y];
+				if (loc[p] < m) {
+					continue;
+				}
 
-	while (!non_visited.empty()) {
-		auto s = SetUtils::popFirst(non_visited);
+				const auto other = elems[m];
+				elems[loc[p]] = other;
+				loc[other] = loc[p];
+				elems[m] = p;
+				loc[p] = m;
 
-		for (auto a : alphabet) {
-			std::set<size_t> u;
-			for (auto p : s) {
-				auto* p_leaf = index_to_leaf[p];
-				if (p_leaf->data == a) {
-					SetUtils::append(u, follow_pos[p_leaf]);
+				if (marked[Y]++ == 0) {
+					touched.push_back(Y);
 				}
 			}
-			auto u_str = SetUtils::toString(u);
-			if (!states.contains(u_str)) {
-				states.insert(u_str);
-				if (u.contains(accept_node_index)) {
-					accept_states.insert(u_str);
-				}
-				non_visited.insert(u);
+		}
+
+		for (auto Y : touched) {
+			const auto m = std::exchange(marked[Y], 0);
+			if (m == end[Y] - first[Y]) {
+				continue;
+			}
+
+			const auto Z = static_cast<uint32_t>(first.size());
+			first.push_back(first[Y]);
+			end.push_back(first[Y] + m);
+			marked.push_back(0);
+			first[Y] += m;
+			for (auto i = first[Z]; i < end[Z]; ++i) {
+				block_of[elems[i]] = Z;
+			}
+
+			in_work.resize(first.size() * k, 0);
+			const auto smaller = end[Z] - first[Z] < end[Y] - first[Y] ? Z : Y;
+			for (size_t g = 0; g < k; ++g) {
+				const auto block = in_work[Y * k + g] ? Z : smaller;
+				in_work[block * k + g] = 1;
+				work.emplace_back(block, g);
 			}
-			transitions[SetUtils::toString(s)][a] = {u_str};
 		}
+		touched.clear();
 	}
 
-	return FiniteAutomaton{
+	// Number blocks in BFS order from the initial one, dropping the dead block
+	const auto dead_block = block_of[dead];
+	std::vector<int64_t> number(first.size(), -1);
+	std::vector<uint32_t> order = {block_of[ids.at(dfa.initial_state())]};
+	number[order.front()] = 0;
+
+	Transitions transitions;
+	for (size_t i = 0; i < order.size(); ++i) {
+		const auto q = elems[first[order[i]]];
+		for (size_t g = 0; g < k; ++g) {
+			const auto to = block_of[delta[q * k + g]];
+			if (to == dead_block) {
+				continue;
+			}
+			if (number[to] == -1) {
+				number[to] = static_cast<int64_t>(order.size());
+				order.push_back(to);
+			}
+			for (auto a : groups[g]) {
+				transitions[std::to_string(i)][a] = {std::to_string(number[to])};
+			}
+		}
+	}
+
+	States states;
+	States accept_states;
+	AcceptPatterns new_accept_patterns;
+	for (size_t i = 0; i < order.size(); ++i) {
+		auto state = std::to_string(i);
+		if (const auto l = label[elems[first[order[i]]]]; l != 0) {
+			accept_states.insert(state);
+			new_accept_patterns[state] = *label_patterns[l];
+		}
+		states.insert(std::move(state));
+	}
+
+	auto result = FiniteAutomaton{
 		std::move(states),
-		std::move(alphabet),
+		dfa.alphabet(),
 		std::move(transitions),
-		std::move(initial_state),
-		std::move(accept_states),
+		"0",
+		std::move(accept_states)
 	};
+
+	return {std::move(result), std::move(new_accept_patterns)};
 }
 
 }  // namespace
 
 
-DeterministicFiniteAutomaton::DeterministicFiniteAutomaton(const FiniteAutomaton& other)
-	: FiniteAutomaton{sBuildDfaFromFa(other)}
+DeterministicFiniteAutomaton::DeterministicFiniteAutomaton(const FiniteAutomaton& other, const BuildOptions& options /* = {} */)
+	: DeterministicFiniteAutomaton{
+		sThreads(options) > 1
+			? sBuildDfaFromFa<ConcurrentSubsetTable>(other, options)
+			: sBuildDfaFromFa<SubsetTable>(other, options)
+	}
+{
+}
+
+DeterministicFiniteAutomaton::DeterministicFiniteAutomaton(std::string_view expression, const BuildOptions& options /* = {} */)
+	: DeterministicFiniteAutomaton{std::vector{std::string{expression}}, options}
 {
 }
 
-DeterministicFiniteAutomaton::DeterministicFiniteAutomaton(std::string_view expression)
-	: FiniteAutomaton{sBuildDfaFromRegex(expression)}
+DeterministicFiniteAutomaton::DeterministicFiniteAutomaton(const std::vector<std::string>& expressions, const BuildOptions& options /* = {} */)
+	: DeterministicFiniteAutomaton{
+		sThreads(options) > 1
+			? sBuildDfaFromRegex<ConcurrentSubsetTable>(expressions, options)
+			: sBuildDfaFromRegex<SubsetTable>(expressions, options)
+	}
+{
+}
+
+DeterministicFiniteAutomaton::DeterministicFiniteAutomaton(std::tuple<FiniteAutomaton, AcceptPatterns, std::optional<BuildStatistics>> automaton)
+	: FiniteAutomaton{std::move(std::get<0>(automaton))}
+	, accept_patterns_{std::move(std::get<1>(automaton))}
+	, statistics_{std::move(std::get<2>(automaton))}
 {
 }
 
@@ -175,3 +708,64 @@ bool DeterministicFiniteAutomaton::accept(std::string_view s) {
 	}
 	return accept_states_.contains(state);
 }
+
+void DeterministicFiniteAutomaton::rename() {
+	const auto translation = rename_();
+
+	AcceptPatterns accept_patterns;
+	for (auto&& [state, patterns] : accept_patterns_) {
+		accept_patterns[translation.at(state)] = std::move(patterns);
+	}
+	accept_patterns_ = std::move(accept_patterns);
+}
+
+DeterministicFiniteAutomaton DeterministicFiniteAutomaton::brzozowski(const FiniteAutomaton& A, const OnStep& onStep /* = {} */) {
+	const auto step = [&](const std::string& name, const FiniteAutomaton& automaton) {
+		if (onStep) {
+			onStep(name, automaton);
+		}
+	};
+
+	auto fa = A.reversed();
+	step("r(A)", fa);
+
+	auto dfa = DeterministicFiniteAutomaton(fa);
+	step("dr(A)", dfa);
+
+	dfa.rename();
+	step("mdr(A)", dfa);
+
+	fa = dfa.reversed();
+	step("rmdr(A)", fa);
+
+	dfa = DeterministicFiniteAutomaton(fa);
+	step("drmdr(A)", dfa);
+
+	dfa.rename();
+	step("mdrmdr(A)", dfa);
+
+	return dfa;
+}
+
+void DeterministicFiniteAutomaton::minimize() {
+	PhaseTimer timer{statistics_ ? &*statistics_ : nullptr, "minimization"};
+
+	auto [dfa, accept_patterns] = sMinimize(*this, accept_patterns_);
+	static_cast<FiniteAutomaton&>(*this) = std::move(dfa);
+	accept_patterns_ = std::move(accept_patterns);
+
+	if (statistics_) {
+		statistics_->minimized_states = states_.size();
+	}
+}
+
+CompiledAutomaton DeterministicFiniteAutomaton::compile() const {
+	if (!statistics_) {
+		return CompiledAutomaton{*this, accept_patterns_};
+	}
+
+	// The compiled automaton gets its own copy, the timer adds "compile" to it after the return
+	const auto statistics = std::make_shared<BuildStatistics>(*statistics_);
+	PhaseTimer timer{statistics.get(), "compile"};
+	return CompiledAutomaton{*this, accept_patterns_, statistics};
+}
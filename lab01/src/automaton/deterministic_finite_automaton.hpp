@@ -1,12 +1,58 @@
 #pragma once
 
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <automaton/build_statistics.hpp>
+#include <automaton/compiled_automaton.hpp>
 #include <automaton/finite_automaton.hpp>
 
 
+struct BuildOptions {
+	// Record BuildStatistics of the construction and of later minimize and compile calls
+	bool collect_statistics = false;
+
+	// Workers of subset construction, 0 for one per hardware thread.
+	// The DFA does not depend on it
+	size_t threads = 1;
+};
+
 class DeterministicFiniteAutomaton : public FiniteAutomaton {
 public:
-	explicit DeterministicFiniteAutomaton(const FiniteAutomaton& other);
-	explicit DeterministicFiniteAutomaton(std::string_view expression);
+	explicit DeterministicFiniteAutomaton(const FiniteAutomaton& other, const BuildOptions& options = {});
+	explicit DeterministicFiniteAutomaton(std::string_view expression, const BuildOptions& options = {});
+
+	// Single DFA for all expressions, accept states know which of them matched
+	explicit DeterministicFiniteAutomaton(const std::vector<std::string>& expressions, const BuildOptions& options = {});
+
+	// Accept states missing here accept pattern 0
+	const AcceptPatterns& acceptPatterns() const { return accept_patterns_; }
+
+	// nullptr if statistics are not collected
+	const BuildStatistics* statistics() const { return statistics_ ? &*statistics_ : nullptr; }
 
 	bool accept(std::string_view s);
+
+	void rename();
+
+	// Hopcroft's minimization, states are renamed to "0", "1", ...
+	void minimize();
+
+	// Brzozowski's minimization mdrmdr(A): reverse, determinize and rename twice.
+	// onStep is called with each intermediate automaton and its name, "r(A)" to "mdrmdr(A)"
+	using OnStep = std::function<void(const std::string& name, const FiniteAutomaton& automaton)>;
+	static DeterministicFiniteAutomaton brzozowski(const FiniteAutomaton& A, const OnStep& onStep = {});
+
+	// Freezes DFA into an immutable table-driven matcher
+	CompiledAutomaton compile() const;
+
+private:
+	AcceptPatterns accept_patterns_;
+	std::optional<BuildStatistics> statistics_;
+
+	explicit DeterministicFiniteAutomaton(std::tuple<FiniteAutomaton, AcceptPatterns, std::optional<BuildStatistics>> automaton);
 };
@@ -1,12 +1,24 @@
 #include <automaton/finite_automaton.hpp>
 
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstdint>
+#include <map>
+#include <queue>
 #include <stdexcept>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 #include <utils/set_utils.hpp>
 
 
 namespace {
 
+// States with more distinct successors than this are emitted as a switch by toCppFormat
+constexpr size_t kMaxTargetTests = 3;
+
 void sForAllTransitions(const Transitions& transitions, auto onTransition) {
 	for (auto&& [from, map_symbol_to_states] : transitions) {
 		for (auto&& [symbol, to_states] : map_symbol_to_states) {
@@ -17,6 +29,76 @@ void sForAllTransitions(const Transitions& transitions, auto onTransition) {
 	}
 }
 
+// Compressed adjacency over dense state ids: successors of v are targets[offsets[v] .. offsets[v + 1])
+struct Adjacency {
+	std::vector<uint32_t> offsets;
+	std::vector<uint32_t> targets;
+};
+
+Adjacency sAdjacency(size_t n, const std::vector<std::pair<uint32_t, uint32_t>>& edges, bool reversed) {
+	Adjacency adjacency;
+	adjacency.offsets.assign(n + 1, 0);
+	for (auto [from, to] : edges) {
+		++adjacency.offsets[(reversed ? to : from) + 1];
+	}
+	for (size_t v = 0; v < n; ++v) {
+		adjacency.offsets[v + 1] += adjacency.offsets[v];
+	}
+
+	auto next = adjacency.offsets;
+	adjacency.targets.resize(edges.size());
+	for (auto [from, to] : edges) {
+		const auto [source, target] = reversed ? std::pair{to, from} : std::pair{from, to};
+		adjacency.targets[next[source]++] = target;
+	}
+	return adjacency;
+}
+
+// Marks everything reachable from the states in stack
+std::vector<bool> sMark(const Adjacency& adjacency, std::vector<uint32_t> stack) {
+	std::vector<bool> marked(adjacency.offsets.size() - 1);
+	for (auto v : stack) {
+		marked[v] = true;
+	}
+	while (!stack.empty()) {
+		const auto v = stack.back();
+		stack.pop_back();
+		for (auto i = adjacency.offsets[v]; i < adjacency.offsets[v + 1]; ++i) {
+			if (const auto w = adjacency.targets[i]; !marked[w]) {
+				marked[w] = true;
+				stack.push_back(w);
+			}
+		}
+	}
+	return marked;
+}
+
+// Character literal for printable ASCII, the number otherwise
+std::string sCppCase(unsigned char byte) {
+	if (byte < 0x80 && std::isprint(byte) && byte != '\\' && byte != '\'') {
+		return std::string{'\'', static_cast<char>(byte), '\''};
+	}
+	return std::to_string(static_cast<unsigned>(byte));
+}
+
+// Sorted bytes -> maximal runs of consecutive values
+std::vector<std::pair<unsigned char, unsigned char>> sByteRanges(const std::vector<unsigned char>& bytes) {
+	std::vector<std::pair<unsigned char, unsigned char>> ranges;
+	for (auto byte : bytes) {
+		if (!ranges.empty() && ranges.back().second + 1 == byte) {
+			ranges.back().second = byte;
+		} else {
+			ranges.emplace_back(byte, byte);
+		}
+	}
+	return ranges;
+}
+
+bool sIsIdentifier(const std::string& name) {
+	const auto is_word = [](char c) { return std::isalnum(static_cast<unsigned char>(c)) || c == '_'; };
+	return !name.empty() && !std::isdigit(static_cast<unsigned char>(name[0])) && std::all_of(name.begin(), name.end(), is_word);
+}
+
 }  // namespace
 
 
@@ -25,13 +107,15 @@ FiniteAutomaton::FiniteAutomaton(
 	Alphabet alphabet /* = {} */,
 	Transitions transitions /* = {} */,
 	State initial_state /* = {} */,
-	States accept_states /* = {} */
+	States accept_states /* = {} */,
+	EpsilonTransitions epsilon_transitions /* = {} */
 )
 	: states_{std::move(states)}
 	, alphabet_{std::move(alphabet)}
 	, transitions_{std::move(transitions)}
 	, initial_state_{std::move(initial_state)}
 	, accept_states_{std::move(accept_states)}
+	, epsilon_transitions_{std::move(epsilon_transitions)}
 {
 	checkStateIsValid_(initial_state_);
 
@@ -48,6 +132,13 @@ FiniteAutomaton::FiniteAutomaton(
 			}
 		}
 	}
+
+	for (auto&& [from, to_states] : epsilon_transitions_) {
+		checkStateIsValid_(from);
+		for (auto&& to : to_states) {
+			checkStateIsValid_(to);
+		}
+	}
 }
 
 void FiniteAutomaton::checkStateIsValid_(const State& state) const {
@@ -57,7 +148,7 @@ void FiniteAutomaton::checkStateIsValid_(const State& state) const {
 }
 
 void FiniteAutomaton::checkSymbolIsValid_(Symbol symbol) const {
-	if (symbol != 'L' && !alphabet_.contains(symbol)) {
+	if (!alphabet_.contains(symbol)) {
 		throw std::invalid_argument("[FiniteAutomaton::CheckSymbolIsValid_] There is no such symbol in the alphabet: '" + std::string{symbol} + "'");
 	}
 }
@@ -74,7 +165,7 @@ void FiniteAutomaton::createInitialState_(const States& initial_states) {
 
 	states_.insert(initial_state_);
 	for (auto&& state : initial_states) {
-		transitions_[initial_state_]['L'].insert(state);
+		epsilon_transitions_[initial_state_].insert(state);
 	}
 }
 
@@ -87,6 +178,13 @@ auto FiniteAutomaton::transition(const State& from, Symbol symbol) const -> Stat
 	return {};
 }
 
+auto FiniteAutomaton::epsilonTransition(const State& from) const -> States {
+	if (auto it = epsilon_transitions_.find(from); it != epsilon_transitions_.end()) {
+		return it->second;
+	}
+	return {};
+}
+
 void FiniteAutomaton::reverse() {
 	if (accept_states_.empty()) {
 		throw std::invalid_argument("[FiniteAutomaton::reverse] Cannot reverse FA without accept states");
@@ -99,6 +197,15 @@ void FiniteAutomaton::reverse() {
 		transitions_[to][symbol].insert(from);
 	});
 
+	auto epsilon_transitions = std::move(epsilon_transitions_);
+	epsilon_transitions_.clear();
+
+	for (auto&& [from, to_states] : epsilon_transitions) {
+		for (auto&& to : to_states) {
+			epsilon_transitions_[to].insert(from);
+		}
+	}
+
 	auto tmp = std::move(initial_state_);
 	if (accept_states_.size() == 1) {
 		initial_state_ = SetUtils::popFirst(accept_states_);
@@ -117,7 +224,11 @@ FiniteAutomaton FiniteAutomaton::reversed() const {
 }
 
 void FiniteAutomaton::rename() {
-	std::unordered_map<std::string, std::string> translation;
+	rename_();
+}
+
+auto FiniteAutomaton::rename_() -> UMap<State, State> {
+	UMap<State, State> translation;
 
 	States new_states;
 
@@ -134,6 +245,13 @@ void FiniteAutomaton::rename() {
 		new_transitions[translation[from]][symbol].insert(translation[to]);
 	});
 
+	EpsilonTransitions new_epsilon_transitions;
+	for (auto&& [from, to_states] : epsilon_transitions_) {
+		for (auto&& to : to_states) {
+			new_epsilon_transitions[translation[from]].insert(translation[to]);
+		}
+	}
+
 	auto new_initial_state = translation[initial_state_];
 
 	States new_accept_states;
@@ -143,31 +261,77 @@ void FiniteAutomaton::rename() {
 
 	states_ = std::move(new_states);
 	transitions_ = std::move(new_transitions);
+	epsilon_transitions_ = std::move(new_epsilon_transitions);
 	initial_state_ = std::move(new_initial_state);
 	accept_states_ = std::move(new_accept_states);
+
+	return translation;
 }
 
 void FiniteAutomaton::deleteUnreachableStates() {
-	auto fa = *this;
-	fa.reverse();
+	// Dense ids and the edge list, λ-transitions included
+	UMap<std::string_view, uint32_t> ids;
+	for (auto&& state : states_) {
+		ids.emplace(state, static_cast<uint32_t>(ids.size()));
+	}
 
-	auto alphabet = fa.alphabet_;
-	alphabet.insert('L');
+	std::vector<std::pair<uint32_t, uint32_t>> edges;
+	sForAllTransitions(transitions_, [&](const State& from, Symbol, const State& to) {
+		edges.emplace_back(ids.at(from), ids.at(to));
+	});
+	for (auto&& [from, to_states] : epsilon_transitions_) {
+		for (auto&& to : to_states) {
+			edges.emplace_back(ids.at(from), ids.at(to));
+		}
+	}
 
-	States visited;
-	States need_to_visit = {fa.initial_state_};
+	// Mark: reachable from the initial state and reaching an accept state over the reverse edges
+	const auto reachable = sMark(sAdjacency(ids.size(), edges, false), {ids.at(initial_state_)});
 
-	while (!need_to_visit.empty()) {
-		auto state = SetUtils::popFirst(need_to_visit);
-		visited.insert(state);
+	std::vector<uint32_t> accepting;
+	for (auto&& state : accept_states_) {
+		accepting.push_back(ids.at(state));
+	}
+	const auto live = sMark(sAdjacency(ids.size(), edges, true), std::move(accepting));
+
+	std::vector<bool> kept(ids.size());
+	for (size_t id = 0; id < kept.size(); ++id) {
+		kept[id] = reachable[id] && live[id];
+	}
+
+	auto keep = [&](const State& state) { return kept[ids.at(state)]; };
 
-		for (auto symbol : alphabet) {
-			SetUtils::append(need_to_visit, SetUtils::difference(fa.transition(state, symbol), visited));
+	// Compact: every container is swept once. Keys of ids point into states_, so it goes last
+	for (auto it = transitions_.begin(); it != transitions_.end();) {
+		if (!keep(it->first)) {
+			it = transitions_.erase(it);
+			continue;
+		}
+		auto& map_symbol_to_states = it->second;
+		for (auto symbol_it = map_symbol_to_states.begin(); symbol_it != map_symbol_to_states.end();) {
+			std::erase_if(symbol_it->second, [&](auto&& to) { return !keep(to); });
+			symbol_it = symbol_it->second.empty() ? map_symbol_to_states.erase(symbol_it) : std::next(symbol_it);
 		}
+		++it;
 	}
 
-	for (auto&& unreachable : SetUtils::difference(fa.states_, visited)) {
-		deleteState(unreachable);
+	for (auto it = epsilon_transitions_.begin(); it != epsilon_transitions_.end();) {
+		if (!keep(it->first)) {
+			it = epsilon_transitions_.erase(it);
+			continue;
+		}
+		std::erase_if(it->second, [&](auto&& to) { return !keep(to); });
+		++it;
+	}
+
+	std::erase_if(accept_states_, [&](auto&& state) { return !keep(state); });
+
+	// The initial state stays without transitions even if the language is empty
+	kept[ids.at(initial_state_)] = true;
+
+	uint32_t id = 0;
+	for (auto it = states_.begin(); it != states_.end(); ++id) {
+		it = kept[id] ? std::next(it) : states_.erase(it);
 	}
 }
 
@@ -184,12 +348,14 @@ void FiniteAutomaton::deleteState(const State& state) {
 		for (auto&& [symbol, to_states] : transitions_[state]) {
 			SetUtils::append(initial_states, to_states);
 		}
+		SetUtils::append(initial_states, epsilon_transitions_[state]);
 		if (!initial_states.empty()) {
 			createInitialState_(initial_states);
 		}
 	}
 
 	transitions_.erase(state);
+	epsilon_transitions_.erase(state);
 
 	for (auto&& [from, map_symbol_to_states] : transitions_) {
 		for (auto&& [symbol, to_states] : map_symbol_to_states) {
@@ -199,6 +365,10 @@ void FiniteAutomaton::deleteState(const State& state) {
 		}
 	}
 
+	for (auto&& [from, to_states] : epsilon_transitions_) {
+		to_states.erase(state);
+	}
+
 	accept_states_.erase(state);
 }
 
@@ -218,7 +388,7 @@ std::string FiniteAutomaton::toDotFormat() const {
 	for (auto&& [from, map_symbol_to_state] : transitions_) {
 		const auto from_str = "\t\"" + from + "\" -> \"";
 		for (auto&& [symbol, to_states] : map_symbol_to_state) {
-			const auto symbol_str = "\" [label=\"" + (symbol == 'L' ? "λ" : std::string{symbol}) + "\"]\n";
+			const auto symbol_str = "\" [label=\"" + std::string{symbol} + "\"]\n";
 			for (auto&& to : to_states) {
 				dot += from_str;
 				dot += to;
@@ -226,7 +396,178 @@ std::string FiniteAutomaton::toDotFormat() const {
 			}
 		}
 	}
+	for (auto&& [from, to_states] : epsilon_transitions_) {
+		for (auto&& to : to_states) {
+			dot += "\t\"" + from + "\" -> \"" + to + "\" [label=\"λ\"]\n";
+		}
+	}
 	dot += "}\n";
 
 	return dot;
 }
+
+std::string FiniteAutomaton::toCppFormat(const std::string& function_name) const {
+	if (!sIsIdentifier(function_name)) {
+		throw std::invalid_argument("[FiniteAutomaton::toCppFormat] \"" + function_name + "\" is not an identifier");
+	}
+
+	for (auto&& [from, to_states] : epsilon_transitions_) {
+		if (!to_states.empty()) {
+			throw std::invalid_argument("[FiniteAutomaton::toCppFormat] FA has λ-transitions in state \"" + from + "\"");
+		}
+	}
+
+	// States that can reach an accept state, the others reject at once
+	UMap<State, States> reverse;
+	sForAllTransitions(transitions_, [&](const State& from, Symbol, const State& to) { reverse[to].insert(from); });
+
+	States live = accept_states_;
+	std::vector<State> stack(accept_states_.begin(), accept_states_.end());
+	while (!stack.empty()) {
+		const auto state = std::move(stack.back());
+		stack.pop_back();
+		for (auto&& from : reverse[state]) {
+			if (live.insert(from).second) {
+				stack.push_back(from);
+			}
+		}
+	}
+
+	// Labels in breadth-first order from the initial state, so that a state
+	// tends to follow its predecessor in the generated code
+	UMap<State, size_t> labels;
+	std::vector<const State*> order;
+	std::queue<const State*> queue;
+	if (live.contains(initial_state_)) {
+		labels[initial_state_] = 0;
+		order.push_back(&initial_state_);
+		queue.push(&initial_state_);
+	}
+
+	std::vector<std::map<size_t, std::vector<unsigned char>>> cases;
+	std::vector<bool> referenced;
+	while (!queue.empty()) {
+		const auto& state = *queue.front();
+		queue.pop();
+
+		// Target label -> bytes, ordered by label
+		std::map<size_t, std::vector<unsigned char>> targets;
+		if (auto it = transitions_.find(state); it != transitions_.end()) {
+			for (auto&& [symbol, to_states] : it->second) {
+				if (to_states.size() > 1) {
+					throw std::invalid_argument("[FiniteAutomaton::toCppFormat] FA is not deterministic in state \"" + state + "\"");
+				}
+				if (to_states.empty() || !live.contains(*to_states.begin())) {
+					continue;
+				}
+
+				const auto& to = *to_states.begin();
+				auto [label, inserted] = labels.emplace(to, labels.size());
+				if (inserted) {
+					order.push_back(&label->first);
+					queue.push(&label->first);
+				}
+				targets[label->second].push_back(static_cast<unsigned char>(symbol));
+			}
+		}
+
+		for (auto& [label, bytes] : targets) {
+			std::sort(bytes.begin(), bytes.end());
+			referenced.resize(std::max(referenced.size(), label + 1));
+			referenced[label] = true;
+		}
+		cases.push_back(std::move(targets));
+	}
+
+	std::string cpp =
+		"// Generated by FiniteAutomaton::toCppFormat, do not edit\n"
+		"\n"
+		"#include <cstdint>\n"
+		"#include <string_view>\n"
+		"\n"
+		"\n";
+
+	if (order.empty()) {
+		cpp += "bool " + function_name + "(std::string_view) noexcept {\n\treturn false;\n}\n";
+		return cpp;
+	}
+
+	// Byte sets of more than one range are tested with a 256-bit mask
+	std::vector<std::string> masks;
+	auto test = [&](const std::vector<unsigned char>& bytes) -> std::string {
+		const auto ranges = sByteRanges(bytes);
+		if (ranges.size() == 1 && ranges[0].first == ranges[0].second) {
+			return "c == " + sCppCase(ranges[0].first);
+		}
+		if (ranges.size() == 1) {
+			return "c >= " + sCppCase(ranges[0].first) + " && c <= " + sCppCase(ranges[0].second);
+		}
+
+		std::array<uint64_t, 4> words = {};
+		for (auto byte : bytes) {
+			words[byte / 64] |= uint64_t{1} << (byte % 64);
+		}
+
+		std::string mask = "{";
+		for (size_t i = 0; i < words.size(); ++i) {
+			mask += (i ? ", " : "") + std::to_string(words[i]) + "u";
+		}
+		mask += "}";
+
+		auto it = std::find(masks.begin(), masks.end(), mask);
+		if (it == masks.end()) {
+			it = masks.insert(it, mask);
+		}
+		return "(kMask" + std::to_string(it - masks.begin()) + "[c >> 6] >> (c & 63)) & 1";
+	};
+
+	std::string body;
+	for (size_t label = 0; label < order.size(); ++label) {
+		body += "\n";
+		if (label < referenced.size() && referenced[label]) {
+			body += "s" + std::to_string(label) + ":\n";
+		}
+
+		body += "\tif (p == end) {\n";
+		body += accept_states_.contains(*order[label]) ? "\t\treturn true;\n" : "\t\treturn false;\n";
+		body += "\t}\n";
+		body += "\tc = static_cast<unsigned char>(*p++);\n";
+
+		// A few targets get one test each, many a switch
+		if (cases[label].size() <= kMaxTargetTests) {
+			for (auto&& [target, bytes] : cases[label]) {
+				body += "\tif (" + test(bytes) + ") goto s" + std::to_string(target) + ";\n";
+			}
+			body += "\treturn false;\n";
+			continue;
+		}
+
+		body += "\tswitch (c) {\n";
+		for (auto&& [target, bytes] : cases[label]) {
+			body += "\t\t";
+			for (auto byte : bytes) {
+				body += "case " + sCppCase(byte) + ": ";
+			}
+			body += "goto s" + std::to_string(target) + ";\n";
+		}
+		body += "\t\tdefault: return false;\n";
+		body += "\t}\n";
+	}
+
+	if (!masks.empty()) {
+		cpp += "namespace {\n\n";
+		for (size_t i = 0; i < masks.size(); ++i) {
+			cpp += "constexpr uint64_t kMask" + std::to_string(i) + "[4] = " + masks[i] + ";\n";
+		}
+		cpp += "\n}  // namespace\n\n\n";
+	}
+
+	cpp += "bool " + function_name + "(std::string_view s) noexcept {\n";
+	cpp += "\tconst auto* p = s.data();\n";
+	cpp += "\tconst auto* const end = p + s.size();\n";
+	cpp += "\tunsigned char c = 0;\n";
+	cpp += body;
+	cpp += "}\n";
+
+	return cpp;
+}
@@ -15,7 +15,8 @@ public:
 		Alphabet alphabet = {},
 		Transitions transitions = {},
 		State initial_state = {},
-		States accept_states = {}
+		States accept_states = {},
+		EpsilonTransitions epsilon_transitions = {}
 	);
 
 	const States& states() const { return states_; }
@@ -23,18 +24,29 @@ public:
 	const Transitions& transitions() const { return transitions_; }
 	const State& initial_state() const { return initial_state_; }
 	const States& accept_states() const { return accept_states_; }
+	const EpsilonTransitions& epsilonTransitions() const { return epsilon_transitions_; }
 
 	States transition(const State& from, Symbol symbol) const;
+	States epsilonTransition(const State& from) const;
 
 	void reverse();  // Do not use this from DFA
 	FiniteAutomaton reversed() const;
 
 	void rename();
+
+	// Deletes states unreachable from the initial state and states that cannot reach an accept
+	// state in one pass, O(states + transitions). The initial state is always kept
 	void deleteUnreachableStates();
 	void deleteState(const State& state);
 
 	std::string toDotFormat() const;
 
+	// Standalone C++ source defining bool function_name(std::string_view) noexcept
+	// that matches whole strings with one goto label per state and a switch over
+	// the next byte. States that cannot reach an accept state are cut off.
+	// Throws std::invalid_argument if FA is not deterministic or function_name is not an identifier
+	std::string toCppFormat(const std::string& function_name) const;
+
 protected:
 	// Конечное множество состояний Q
 	States states_;
@@ -51,6 +63,9 @@ protected:
 	// Множество конечных состояний F ⊆ Q
 	States accept_states_;
 
+	// λ-переходы, хранятся отдельно, поэтому любой байт может быть символом Σ
+	EpsilonTransitions epsilon_transitions_;
+
 	void checkStateIsValid_(const State& state) const;
 	void checkSymbolIsValid_(Symbol symbol) const;
 
@@ -58,4 +73,7 @@ protected:
 	void forAllTransitions_(OnTransition onTransition);
 
 	void createInitialState_(const States& initial_states);
+
+	// Renames states to "0", "1", ... and returns old name -> new name
+	UMap<State, State> rename_();
 };
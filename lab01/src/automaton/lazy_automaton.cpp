@@ -0,0 +1,80 @@
+#include <automaton/lazy_automaton.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+
+
+LazyAutomaton::LazyAutomaton(std::string_view expression, size_t cache_capacity /* = kDefaultCacheCapacity */)
+	: positions_{std::vector{std::string{expression}}}
+	, cache_capacity_{cache_capacity}
+{
+	if (cache_capacity_ < 2) {
+		throw std::invalid_argument("[LazyAutomaton::LazyAutomaton] Cache must hold at least 2 states");
+	}
+
+	clearCache_();
+}
+
+bool LazyAutomaton::accept(std::string_view s) {
+	const auto& classes = positions_.classes();
+	const auto width = classes.count();
+
+	StateId state = 0;  // Initial state is always materialised first
+	for (auto c : s) {
+		const auto id = classes.classOf(c);
+
+		auto next = transitions_[state * width + id];
+		if (next == kUnknown) {
+			next = next_(state, id);
+		}
+		state = next;
+
+		if (table_[state].empty()) {
+			return false;
+		}
+	}
+
+	return accepting_[state];
+}
+
+void LazyAutomaton::clearCache_() {
+	table_.clear();
+	transitions_.clear();
+	accepting_.clear();
+
+	materialize_(positions_.initial());
+}
+
+auto LazyAutomaton::materialize_(Subset subset) -> StateId {
+	auto [id, inserted] = table_.intern(std::move(subset));
+	if (inserted) {
+		transitions_.resize(table_.size() * positions_.classes().count(), kUnknown);
+
+		const auto& positions = table_[id];
+		accepting_.push_back(std::any_of(positions.begin(), positions.end(), [&](auto p) {
+			return positions_.endPattern(p) != PositionAutomaton::kNoPattern;
+		}));
+	}
+	return id;
+}
+
+auto LazyAutomaton::next_(StateId state, ByteClasses::ClassId id) -> StateId {
+	const auto width = positions_.classes().count();
+	auto subset = positions_.move(table_[state], id);
+
+	if (const auto cached = table_.find(subset)) {
+		transitions_[state * width + id] = *cached;
+		return *cached;
+	}
+
+	// Only a state that has to be added can overflow the cache
+	if (table_.size() >= cache_capacity_) {
+		++cache_clears_;
+		clearCache_();
+		return materialize_(std::move(subset));
+	}
+
+	const auto next = materialize_(std::move(subset));
+	transitions_[state * width + id] = next;
+	return next;
+}
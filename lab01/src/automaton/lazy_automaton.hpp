@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <automaton/position_automaton.hpp>
+#include <automaton/subset_table.hpp>
+
+
+// DFA that is determinized on demand while matching. Only states reached by
+// the input are materialised from followpos sets; when the cache holds
+// cache_capacity states and a new one is needed it is cleared and refilled
+// from the current state.
+class LazyAutomaton {
+public:
+	using StateId = uint32_t;
+
+	static constexpr size_t kDefaultCacheCapacity = 4096;
+
+	explicit LazyAutomaton(std::string_view expression, size_t cache_capacity = kDefaultCacheCapacity);
+
+	// Not const: materialises the states it passes through
+	bool accept(std::string_view s);
+
+	size_t cachedStates() const { return table_.size(); }
+	size_t cacheClears() const { return cache_clears_; }
+
+private:
+	static constexpr StateId kUnknown = UINT32_MAX;
+
+	PositionAutomaton positions_;
+	size_t cache_capacity_;
+	size_t cache_clears_ = 0;
+
+	SubsetTable table_;
+	std::vector<StateId> transitions_;  // Row per cached state, column per byte class
+	std::vector<bool> accepting_;
+
+	void clearCache_();
+	StateId materialize_(Subset subset);
+	StateId next_(StateId state, ByteClasses::ClassId id);
+};
@@ -0,0 +1,96 @@
+#include <automaton/position_automaton.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#include <parser/abstract_syntax_tree.hpp>
+#include <parser/recursive_descent_parser.hpp>
+
+
+// Expressions are joined under a single '|' root, each one followed by its own end marker leaf
+PositionAutomaton::PositionAutomaton(const std::vector<std::string>& expressions) {
+	if (expressions.empty()) {
+		throw std::invalid_argument("[PositionAutomaton::PositionAutomaton] No expressions");
+	}
+
+	RecursiveDescentParser parser;
+	AbstractSyntaxTreeArena arena;
+	NodeId root = kNoNode;
+	std::vector<NodeId> end_markers;
+	for (auto&& expression : expressions) {
+		end_markers.push_back(arena.create({NodeKind::EndMarker}));
+		const auto pattern = arena.create({NodeKind::Cat}, parser.parse(expression, arena), end_markers.back());
+		root = root != kNoNode ? arena.create({NodeKind::Or}, root, pattern) : pattern;
+	}
+
+	auto ast = AbstractSyntaxTree{std::move(arena), root};
+
+	const auto& leaf_to_index = ast.leafToIndex();
+	const auto& index_to_leaf = ast.indexToLeaf();
+	const auto& follow_pos = ast.followPos();
+
+	const auto initial = ast.firstPos(root);
+	initial_.assign(initial.begin(), initial.end());
+
+	// Slot 0 is unused
+	position_sets_.assign(index_to_leaf.size(), kNoSet);
+	follow_.resize(index_to_leaf.size());
+	end_patterns_.assign(index_to_leaf.size(), kNoPattern);
+
+	for (size_t i = 0; i < end_markers.size(); ++i) {
+		end_patterns_[leaf_to_index[end_markers[i]]] = static_cast<int64_t>(i);
+	}
+
+	// Every distinct byte set of a leaf refines the classes once
+	UMap<ByteSet, uint32_t> set_ids;
+	for (size_t index = 1; index < index_to_leaf.size(); ++index) {
+		const auto leaf = index_to_leaf[index];
+		follow_[index].assign(follow_pos[leaf].begin(), follow_pos[leaf].end());
+
+		const auto bytes = ast.bytes(leaf);
+		if (end_patterns_[index] != kNoPattern || bytes.none()) {
+			continue;
+		}
+
+		auto [it, inserted] = set_ids.emplace(bytes, static_cast<uint32_t>(byte_sets_.size()));
+		if (inserted) {
+			byte_sets_.push_back(bytes);
+			classes_.split(bytes);
+		}
+		position_sets_[index] = it->second;
+	}
+
+	// Classes never straddle a set, so the representative decides membership
+	set_classes_.resize(byte_sets_.size());
+	for (size_t set = 0; set < byte_sets_.size(); ++set) {
+		for (size_t id = 0; id < classes_.count(); ++id) {
+			set_classes_[set][id] = byte_sets_[set][static_cast<unsigned char>(classes_.representative(static_cast<ByteClasses::ClassId>(id)))];
+		}
+
+		for (size_t b = 0; b < 256; ++b) {
+			if (byte_sets_[set][b]) {
+				alphabet_.insert(static_cast<Symbol>(b));
+			}
+		}
+	}
+}
+
+const ByteSet& PositionAutomaton::bytes(uint32_t position) const {
+	static const ByteSet kEmpty;
+	return position_sets_[position] == kNoSet ? kEmpty : byte_sets_[position_sets_[position]];
+}
+
+Subset PositionAutomaton::move(const Subset& subset, ByteClasses::ClassId id) const {
+	Subset result;
+	for (auto p : subset) {
+		if (position_sets_[p] != kNoSet && set_classes_[position_sets_[p]][id]) {
+			result.insert(result.end(), follow_[p].begin(), follow_[p].end());
+		}
+	}
+
+	std::sort(result.begin(), result.end());
+	result.erase(std::unique(result.begin(), result.end()), result.end());
+
+	return result;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <automaton/byte_classes.hpp>
+#include <automaton/subset_table.hpp>
+#include <types/common.hpp>
+
+
+// Glushkov automaton of one or more regular expressions.
+// Positions are the numbered leaves of the AST (starting from 1), each
+// expression is followed by its own end marker position. A position matches
+// a set of bytes, so a class like [a-z] is one position.
+class PositionAutomaton {
+public:
+	static constexpr int64_t kNoPattern = -1;
+
+	// Throws std::invalid_argument if expressions is empty
+	explicit PositionAutomaton(const std::vector<std::string>& expressions);
+
+	size_t size() const { return follow_.size(); }
+
+	const Alphabet& alphabet() const { return alphabet_; }
+	const ByteClasses& classes() const { return classes_; }
+
+	// firstpos of the root
+	const Subset& initial() const { return initial_; }
+
+	// Bytes matched by position, empty for end markers and empty leaves
+	const ByteSet& bytes(uint32_t position) const;
+	const Subset& follow(uint32_t position) const { return follow_[position]; }
+
+	// Index of the expression ended by position or kNoPattern
+	int64_t endPattern(uint32_t position) const { return end_patterns_[position]; }
+
+	// Positions reached from subset by a byte of class id, sorted
+	Subset move(const Subset& subset, ByteClasses::ClassId id) const;
+
+private:
+	Alphabet alphabet_;
+	ByteClasses classes_;
+	Subset initial_;
+
+	static constexpr uint32_t kNoSet = UINT32_MAX;
+
+	std::vector<ByteSet> byte_sets_;              // distinct byte sets of the leaves
+	std::vector<std::bitset<256>> set_classes_;  // class ids covered by each of byte_sets_
+	std::vector<uint32_t> position_sets_;        // index into byte_sets_ or kNoSet
+	std::vector<Subset> follow_;
+	std::vector<int64_t> end_patterns_;
+};
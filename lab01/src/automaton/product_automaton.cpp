@@ -0,0 +1,153 @@
+#include <automaton/product_automaton.hpp>
+
+#include <algorithm>
+
+
+ProductAutomaton::ProductAutomaton(CompiledAutomaton a, CompiledAutomaton b, Operation operation)
+	: a_{std::move(a)}
+	, b_{std::move(b)}
+	, operation_{operation}
+	, live_a_{a_.liveStates()}
+	, live_b_{b_.liveStates()}
+{
+	// Pair of operand classes -> product class, -1 until seen
+	std::vector<int> class_of(a_.classCount() * b_.classCount(), -1);
+	for (size_t byte = 0; byte < 256; ++byte) {
+		const auto c = static_cast<char>(byte);
+		auto& id = class_of[a_.classOf(c) * b_.classCount() + b_.classOf(c)];
+		if (id == -1) {
+			id = static_cast<int>(representatives_.size());
+			representatives_.push_back(static_cast<unsigned char>(byte));
+		}
+		class_map_[byte] = static_cast<ByteClasses::ClassId>(id);
+	}
+
+	materialize_(a_.initialState(), b_.initialState());
+}
+
+bool ProductAutomaton::accept(std::string_view s) {
+	const auto width = classCount();
+
+	StateId state = 0;  // Pair of initial states is always materialised first
+	for (auto c : s) {
+		if (isDead_(state)) {
+			return false;
+		}
+
+		const auto id = class_map_[static_cast<unsigned char>(c)];
+		auto next = transitions_[state * width + id];
+		if (next == kUnknown) {
+			next = next_(state, id);
+		}
+		state = next;
+	}
+
+	return isAccepting_(state);
+}
+
+std::optional<std::string> ProductAutomaton::witness() {
+	// Breadth-first with classes in byte order of their representatives, each pair
+	// remembers the pair and byte it was first reached from. A pair is tested when
+	// it is reached, so the layer after the shortest witness is never expanded
+	std::vector<StateId> parent = {kUnknown};
+	std::vector<unsigned char> via = {0};
+	std::vector<StateId> queue = {0};
+
+	const auto word = [&](StateId state) {
+		std::string result;
+		for (auto s = state; s != 0; s = parent[s]) {
+			result.push_back(static_cast<char>(via[s]));
+		}
+		std::reverse(result.begin(), result.end());
+		return result;
+	};
+
+	if (isAccepting_(0)) {
+		return word(0);
+	}
+
+	for (size_t head = 0; head < queue.size(); ++head) {
+		const auto state = queue[head];
+		if (isDead_(state)) {
+			continue;
+		}
+
+		// size_t, as there may be 256 classes
+		for (size_t id = 0; id < classCount(); ++id) {
+			auto next = transitions_[state * classCount() + id];
+			if (next == kUnknown) {
+				next = next_(state, static_cast<ByteClasses::ClassId>(id));
+			}
+
+			parent.resize(pairs_.size(), kUnknown);
+			via.resize(pairs_.size(), 0);
+			if (next != 0 && parent[next] == kUnknown) {
+				parent[next] = state;
+				via[next] = representatives_[id];
+				if (isAccepting_(next)) {
+					return word(next);
+				}
+				queue.push_back(next);
+			}
+		}
+	}
+
+	return std::nullopt;
+}
+
+size_t ProductAutomaton::materialize() {
+	for (StateId state = 0; state < pairs_.size(); ++state) {
+		if (isDead_(state)) {
+			continue;
+		}
+		for (size_t id = 0; id < classCount(); ++id) {
+			if (transitions_[state * classCount() + id] == kUnknown) {
+				next_(state, static_cast<ByteClasses::ClassId>(id));
+			}
+		}
+	}
+	return pairs_.size();
+}
+
+bool ProductAutomaton::isAccepting_(StateId state) const {
+	const auto in_a = a_.isAccepting(pairs_[state].first);
+	const auto in_b = b_.isAccepting(pairs_[state].second);
+
+	switch (operation_) {
+		case Operation::Intersection: return in_a && in_b;
+		case Operation::Union: return in_a || in_b;
+		case Operation::Difference: return in_a && !in_b;
+		case Operation::SymmetricDifference: return in_a != in_b;
+	}
+	return false;
+}
+
+bool ProductAutomaton::isDead_(StateId state) const {
+	const auto dead_a = !live_a_[pairs_[state].first];
+	const auto dead_b = !live_b_[pairs_[state].second];
+
+	switch (operation_) {
+		case Operation::Intersection: return dead_a || dead_b;
+		case Operation::Difference: return dead_a;
+		case Operation::Union:
+		case Operation::SymmetricDifference: return dead_a && dead_b;
+	}
+	return false;
+}
+
+auto ProductAutomaton::materialize_(CompiledAutomaton::StateId p, CompiledAutomaton::StateId q) -> StateId {
+	const auto [it, inserted] = ids_.try_emplace(uint64_t{p} << 32 | q, static_cast<StateId>(pairs_.size()));
+	if (inserted) {
+		pairs_.emplace_back(p, q);
+		transitions_.resize(pairs_.size() * classCount(), kUnknown);
+	}
+	return it->second;
+}
+
+auto ProductAutomaton::next_(StateId state, ByteClasses::ClassId id) -> StateId {
+	const auto c = static_cast<char>(representatives_[id]);
+	const auto [p, q] = pairs_[state];
+	const auto next = materialize_(a_.next(p, c), b_.next(q, c));
+	transitions_[state * classCount() + id] = next;
+	return next;
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <automaton/byte_classes.hpp>
+#include <automaton/compiled_automaton.hpp>
+#include <types/common.hpp>
+
+
+// Product of two compiled automata built on demand. A state is a pair of
+// their states; only pairs reached from the pair of initial states are
+// materialised, and pairs that can no longer accept under the operation are
+// never expanded. Operands are copied, which only shares their tables.
+class ProductAutomaton {
+public:
+	using StateId = uint32_t;
+
+	enum class Operation {
+		Intersection,         // L(a) ∩ L(b)
+		Union,                // L(a) ∪ L(b)
+		Difference,           // L(a) \ L(b)
+		SymmetricDifference,  // L(a) △ L(b), empty iff a and b are equivalent
+	};
+
+	ProductAutomaton(CompiledAutomaton a, CompiledAutomaton b, Operation operation);
+
+	// Not const: materialises the pairs it passes through
+	bool accept(std::string_view s);
+
+	// Shortest string of the product language, the least by bytes among equally short ones,
+	// or nothing if the language is empty. The search stops at the first accepting pair
+	std::optional<std::string> witness();
+
+	bool isEmpty() { return !witness().has_value(); }
+
+	// Materialises every reachable pair, returns their number
+	size_t materialize();
+
+	size_t materializedStates() const { return pairs_.size(); }
+	size_t classCount() const { return representatives_.size(); }
+
+private:
+	static constexpr StateId kUnknown = UINT32_MAX;
+
+	CompiledAutomaton a_;
+	CompiledAutomaton b_;
+	Operation operation_;
+
+	// Operand states that can still reach an accepting state; an operand need
+	// not be minimal, so it may have sinks other than its dead state
+	std::vector<bool> live_a_;
+	std::vector<bool> live_b_;
+
+	// Classes of bytes that no operand tells apart, each with its smallest byte
+	std::array<ByteClasses::ClassId, 256> class_map_ = {};
+	std::vector<unsigned char> representatives_;
+
+	std::vector<std::pair<CompiledAutomaton::StateId, CompiledAutomaton::StateId>> pairs_;
+	UMap<uint64_t, StateId> ids_;
+	std::vector<StateId> transitions_;  // Row per pair, column per class
+
+	bool isAccepting_(StateId state) const;
+
+	// No accepting pair is reachable, judged by which operand states are live
+	bool isDead_(StateId state) const;
+
+	StateId materialize_(CompiledAutomaton::StateId p, CompiledAutomaton::StateId q);
+	StateId next_(StateId state, ByteClasses::ClassId id);
+};
@@ -0,0 +1,232 @@
+#include <automaton/searcher.hpp>
+
+#include <algorithm>
+#include <utility>
+
+
+Searcher::Runs_::Runs_(const CompiledAutomaton& automaton)
+	: automaton_{&automaton}
+	, slots_(automaton.stateCount(), kNoSlot)
+{
+}
+
+void Searcher::Runs_::add(CompiledAutomaton::StateId state, size_t origin) {
+	if (slots_[state] == kNoSlot) {
+		slots_[state] = runs_.size();
+		runs_.push_back({state, origin});
+	}
+}
+
+void Searcher::Runs_::step(char c) {
+	for (auto&& run : runs_) {
+		slots_[run.state] = kNoSlot;
+	}
+
+	next_.clear();
+	for (auto&& run : runs_) {
+		const auto state = automaton_->next(run.state, c);
+		if (state != CompiledAutomaton::kDeadState && slots_[state] == kNoSlot) {
+			slots_[state] = next_.size();
+			next_.push_back({state, run.origin});
+		}
+	}
+
+	std::swap(runs_, next_);
+}
+
+// Runs are ordered by origin, so the ones to drop are at the back
+void Searcher::Runs_::dropAfter(size_t origin) {
+	while (!runs_.empty() && runs_.back().origin > origin) {
+		slots_[runs_.back().state] = kNoSlot;
+		runs_.pop_back();
+	}
+}
+
+void Searcher::Runs_::clear() {
+	for (auto&& run : runs_) {
+		slots_[run.state] = kNoSlot;
+	}
+	runs_.clear();
+}
+
+
+Searcher::Searcher(CompiledAutomaton automaton)
+	: forward_{std::move(automaton)}
+	, unanchored_{forward_.unanchored()}
+	, prefixes_{forward_.prefixes().reversed()}
+{
+}
+
+auto Searcher::find(std::string_view text, size_t from /* = 0 */) const -> std::optional<Match> {
+	return Matches{*this, text}.next_(from);
+}
+
+auto Searcher::findAll(std::string_view text) const -> std::vector<Match> {
+	std::vector<Match> result;
+	for (auto&& match : matches(text)) {
+		result.push_back(match);
+	}
+	return result;
+}
+
+auto Searcher::matches(std::string_view text) const -> Matches {
+	return Matches{*this, text};
+}
+
+Searcher::Matches::Matches(const Searcher& searcher, std::string_view text)
+	: searcher_{&searcher}
+	, text_{text}
+	, runs_{searcher.forward_}
+{
+}
+
+auto Searcher::Matches::next_(size_t from) -> std::optional<Match> {
+	const auto& forward = searcher_->forward_;
+	const auto& unanchored = searcher_->unanchored_;
+	const auto& prefixes = searcher_->prefixes_;
+
+	if (from > text_.size()) {
+		return std::nullopt;
+	}
+
+	// Earliest end of a match that begins at or after from
+	auto state = unanchored.initialState();
+	auto end = from;
+	while (!unanchored.isAccepting(state)) {
+		if (state == CompiledAutomaton::kDeadState || end == text_.size()) {
+			return std::nullopt;
+		}
+		state = unanchored.next(state, text_[end++]);
+		++steps_;
+	}
+
+	// A match can only begin where text up to end is a prefix of a word of L
+	auto begin = end;
+	state = prefixes.initialState();
+	for (auto i = end; state != CompiledAutomaton::kDeadState; --i) {
+		if (prefixes.isAccepting(state)) {
+			begin = i;
+		}
+		if (i == from) {
+			break;
+		}
+		state = prefixes.next(state, text_[i - 1]);
+		++steps_;
+	}
+
+	// Runs are ordered by origin, so the first accepting one is the leftmost match
+	// ending here. The leftmost start is known once every run before it has died
+	std::optional<Match> best;
+	runs_.clear();
+	for (auto i = begin; ; ++i) {
+		if (!best) {
+			runs_.add(forward.initialState(), i);
+		}
+
+		for (auto&& run : runs_.runs()) {
+			if (forward.isAccepting(run.state)) {
+				if (!best || run.origin <= best->begin) {
+					best = Match{run.origin, i};
+				}
+				break;
+			}
+		}
+
+		if (best) {
+			runs_.dropAfter(best->begin);
+			if (runs_.runs().empty()) {
+				break;
+			}
+
+			if (const auto& run = runs_.runs().front(); run.origin == best->begin) {
+				if (const auto last = longestEnd_(i, run.state); last != kNone) {
+					best->end = std::max(best->end, last);
+				}
+				break;
+			}
+		}
+
+		if (i == text_.size()) {
+			break;
+		}
+		steps_ += runs_.runs().size();
+		runs_.step(text_[i]);
+	}
+
+	return best;
+}
+
+// The run goes on alone until it meets the kept run or dies, in which case it is kept instead
+size_t Searcher::Matches::longestEnd_(size_t position, CompiledAutomaton::StateId state) {
+	const auto& forward = searcher_->forward_;
+
+	const auto start = state;
+	auto last = kNone;
+	for (auto i = position; ; ++i) {
+		if (forward.isAccepting(state)) {
+			last = i;
+		}
+
+		if (const auto known = traceState_(i, position); known && *known == state) {
+			if (trace_end_ != kNone && trace_end_ >= i) {
+				last = trace_end_;
+			}
+			return last;
+		}
+
+		if (state == CompiledAutomaton::kDeadState || i == text_.size()) {
+			trace_begin_ = position;
+			trace_.assign(1, start);
+			trace_end_ = last;
+			return last;
+		}
+
+		state = forward.next(state, text_[i]);
+		++steps_;
+	}
+}
+
+// The trace is extended by running it on, and positions before keep_from are
+// dropped once they are more than half of it
+auto Searcher::Matches::traceState_(size_t position, size_t keep_from) -> std::optional<CompiledAutomaton::StateId> {
+	const auto& forward = searcher_->forward_;
+
+	if (trace_.empty() || position < trace_begin_) {
+		return std::nullopt;
+	}
+
+	if (const auto drop = std::min(keep_from - std::min(keep_from, trace_begin_), trace_.size() - 1); 2 * drop > trace_.size()) {
+		trace_.erase(trace_.begin(), trace_.begin() + static_cast<std::ptrdiff_t>(drop));
+		trace_begin_ += drop;
+	}
+
+	while (trace_begin_ + trace_.size() <= position) {
+		const auto at = trace_begin_ + trace_.size() - 1;
+		if (trace_.back() == CompiledAutomaton::kDeadState || at == text_.size()) {
+			return std::nullopt;
+		}
+		trace_.push_back(forward.next(trace_.back(), text_[at]));
+		++steps_;
+	}
+	return trace_[position - trace_begin_];
+}
+
+Searcher::Matches::Iterator::Iterator(Matches* matches)
+	: matches_{matches}
+{
+	seek_(0);
+}
+
+auto Searcher::Matches::Iterator::operator++() -> Iterator& {
+	seek_(match_.end > match_.begin ? match_.end : match_.begin + 1);
+	return *this;
+}
+
+void Searcher::Matches::Iterator::seek_(size_t from) {
+	const auto match = matches_->next_(from);
+	if (!match) {
+		matches_ = nullptr;
+		return;
+	}
+	match_ = *match;
+}
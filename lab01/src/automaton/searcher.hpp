@@ -0,0 +1,154 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include <automaton/compiled_automaton.hpp>
+
+
+// Unanchored search for matches of a compiled automaton in a text with
+// leftmost-longest semantics, one match at a time:
+//  - the DFA of Σ*·L reads on from the search position to the earliest end of a match;
+//  - the reversed DFA of the prefixes of L reads back from there to the first
+//    position where a match can begin;
+//  - from there the DFA runs from every start at once, one run per state, until
+//    the run of the leftmost start accepts and every run left of it has died;
+//  - that run goes on until the DFA dies to find the longest end.
+// The last run that went on alone is kept as a trace. A later run that meets it
+// in the same state at the same position ends where it does, so the text is read
+// a bounded number of times even when matches are much shorter than the lookahead.
+class Searcher {
+public:
+	// Match occupies text[begin, end)
+	struct Match {
+		size_t begin = 0;
+		size_t end = 0;
+
+		bool operator==(const Match&) const = default;
+	};
+
+	class Matches;
+
+	explicit Searcher(CompiledAutomaton automaton);
+
+	// Leftmost-longest match that begins at or after from
+	std::optional<Match> find(std::string_view text, size_t from = 0) const;
+
+	// Non-overlapping matches from left to right, an empty match advances by one byte.
+	// Linear in the size of text for a given automaton
+	std::vector<Match> findAll(std::string_view text) const;
+
+	// Lazy range of the same matches as findAll, each one is searched for when the
+	// iterator advances. Memory is bounded by the lookahead of the DFA, not the text
+	Matches matches(std::string_view text) const;
+
+private:
+	class Runs_;
+
+	CompiledAutomaton forward_;
+	CompiledAutomaton unanchored_;
+	CompiledAutomaton prefixes_;  // Reversed
+};
+
+
+// Runs of one DFA started at different positions, at most one per state. Runs
+// in the same state have the same future, so the first one added is kept;
+// stepping keeps the order in which runs were added
+class Searcher::Runs_ {
+public:
+	struct Run {
+		CompiledAutomaton::StateId state;
+		size_t origin;
+	};
+
+	explicit Runs_(const CompiledAutomaton& automaton);
+
+	const std::vector<Run>& runs() const { return runs_; }
+
+	// Does nothing if a run is already in state
+	void add(CompiledAutomaton::StateId state, size_t origin);
+
+	// Reads c in every run, runs that die or meet an earlier run are dropped
+	void step(char c);
+
+	// Drops the runs that started after origin
+	void dropAfter(size_t origin);
+
+	void clear();
+
+private:
+	static constexpr size_t kNoSlot = SIZE_MAX;
+
+	const CompiledAutomaton* automaton_;
+	std::vector<size_t> slots_;  // State -> index of its run
+	std::vector<Run> runs_;
+	std::vector<Run> next_;
+};
+
+
+class Searcher::Matches {
+public:
+	class Iterator {
+	public:
+		using iterator_category = std::input_iterator_tag;
+		using value_type = Match;
+		using difference_type = std::ptrdiff_t;
+
+		Iterator() = default;
+
+		const Match& operator*() const { return match_; }
+		const Match* operator->() const { return &match_; }
+
+		Iterator& operator++();
+		void operator++(int) { ++*this; }
+
+		bool operator==(std::default_sentinel_t) const { return !matches_; }
+
+	private:
+		friend class Matches;
+
+		Matches* matches_ = nullptr;
+		Match match_;
+
+		explicit Iterator(Matches* matches);
+		void seek_(size_t from);
+	};
+
+	Iterator begin() { return Iterator{this}; }
+	std::default_sentinel_t end() const { return {}; }
+
+	// DFA transitions taken so far, at most a constant times the size of the text read
+	size_t steps() const { return steps_; }
+
+private:
+	friend class Searcher;
+
+	static constexpr size_t kNone = SIZE_MAX;
+
+	const Searcher* searcher_;
+	std::string_view text_;
+	Runs_ runs_;
+	size_t steps_ = 0;
+
+	// States of the forward DFA along the kept run from trace_begin_, as far as
+	// they have been needed, and the last position where that run accepts
+	size_t trace_begin_ = 0;
+	std::vector<CompiledAutomaton::StateId> trace_;
+	size_t trace_end_ = kNone;
+
+	Matches(const Searcher& searcher, std::string_view text);
+
+	// Leftmost-longest match that begins at or after from
+	std::optional<Match> next_(size_t from);
+
+	// Last position where the forward DFA in state at position accepts, or kNone
+	size_t longestEnd_(size_t position, CompiledAutomaton::StateId state);
+
+	// State of the kept run at position, if it is known. Positions before keep_from
+	// will not be asked for again
+	std::optional<CompiledAutomaton::StateId> traceState_(size_t position, size_t keep_from);
+};
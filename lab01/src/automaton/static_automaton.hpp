@@ -0,0 +1,414 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <parser/regex_grammar.hpp>
+
+
+// String literal usable as a template argument
+template <size_t N>
+struct FixedString {
+	char data[N] = {};
+
+	constexpr FixedString(const char (&s)[N]) { std::copy_n(s, N, data); }
+
+	constexpr std::string_view view() const { return {data, N - 1}; }
+};
+
+
+// Regex -> Glushkov positions -> subset construction -> Moore minimization
+// during constant evaluation. The pattern is read by RegexGrammar, as at run
+// time; a malformed pattern throws std::invalid_argument, which turns into a
+// compile error at the throw. Uses std::vector, so nothing it allocates
+// outlives the evaluation: results are copied into fixed-size Tables.
+class StaticCompiler {
+public:
+	struct Shape {
+		size_t state_count;  // dead state included, max_states + 1 if the budget was exceeded
+		size_t class_count;
+	};
+
+	template <size_t States, size_t Classes>
+	struct Table {
+		using StateId = std::conditional_t<States <= 0x100, uint8_t, std::conditional_t<States <= 0x10000, uint16_t, uint32_t>>;
+
+		std::array<uint8_t, 256> class_map = {};
+		std::array<StateId, States * Classes> table = {};
+		std::array<bool, States> accepting = {};
+		StateId initial_state = 0;
+	};
+
+	// max_states bounds subset construction, before minimization
+	static constexpr Shape shape(std::string_view pattern, size_t max_states) {
+		StaticCompiler compiler{pattern, max_states};
+		return {compiler.state_count_, compiler.class_count_};
+	}
+
+	// States and Classes are those of shape
+	template <size_t States, size_t Classes>
+	static constexpr Table<States, Classes> table(std::string_view pattern, size_t max_states) {
+		StaticCompiler compiler{pattern, max_states};
+
+		Table<States, Classes> result;
+		if (compiler.state_count_ != States || compiler.class_count_ != Classes) {
+			return result;
+		}
+
+		using StateId = typename Table<States, Classes>::StateId;
+		for (size_t b = 0; b < 256; ++b) {
+			result.class_map[b] = static_cast<uint8_t>(compiler.class_map_[b]);
+		}
+		for (size_t i = 0; i < States * Classes; ++i) {
+			result.table[i] = static_cast<StateId>(compiler.table_[i]);
+		}
+		for (size_t state = 0; state < States; ++state) {
+			result.accepting[state] = compiler.accepting_[state];
+		}
+		result.initial_state = static_cast<StateId>(compiler.initial_state_);
+
+		return result;
+	}
+
+private:
+	using Positions_ = std::vector<uint32_t>;  // sorted
+
+	static constexpr Positions_ union_(const Positions_& a, const Positions_& b) {
+		Positions_ result;
+		std::set_union(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(result));
+		return result;
+	}
+
+	// RegexGrammar builder of the Glushkov construction: every fragment knows its
+	// first and last positions, follow is filled as fragments are joined. The
+	// positions made for a fragment are the range [begin, end), so a clone is the
+	// range shifted to the end with the follow links inside it
+	class Glushkov_ {
+	public:
+		struct Node {
+			Positions_ first;
+			Positions_ last;
+			bool nullable = true;
+			uint32_t begin = 0;
+			uint32_t end = 0;
+		};
+
+		// Position 0 is the start, it reads no byte
+		std::vector<ByteMask> bytes = std::vector<ByteMask>(1);
+		std::vector<Positions_> follow = std::vector<Positions_>(1);
+
+		constexpr Node empty() const { return {}; }
+
+		constexpr Node leaf(const ByteMask& mask) {
+			const auto p = static_cast<uint32_t>(bytes.size());
+			bytes.push_back(mask);
+			follow.emplace_back();
+			return {{p}, {p}, false, p, p + 1};
+		}
+
+		constexpr Node cat(const Node& a, const Node& b) {
+			link_(a.last, b.first);
+
+			Node result;
+			if (a.nullable) {
+				result.first = union_(a.first, b.first);
+			} else {
+				result.first = a.first;
+			}
+			if (b.nullable) {
+				result.last = union_(a.last, b.last);
+			} else {
+				result.last = b.last;
+			}
+			result.nullable = a.nullable && b.nullable;
+			span_(result, a, b);
+			return result;
+		}
+
+		constexpr Node alternative(const Node& a, const Node& b) const {
+			Node result = {union_(a.first, b.first), union_(a.last, b.last), a.nullable || b.nullable};
+			span_(result, a, b);
+			return result;
+		}
+
+		constexpr Node star(Node node) { return optional(plus(std::move(node))); }
+
+		constexpr Node plus(Node node) {
+			link_(node.last, node.first);
+			return node;
+		}
+
+		constexpr Node optional(Node node) const {
+			node.nullable = true;
+			return node;
+		}
+
+		constexpr Node clone(const Node& node) {
+			const auto shift = static_cast<uint32_t>(bytes.size()) - node.begin;
+			const auto shifted = [&](const Positions_& positions) {
+				Positions_ result;
+				for (auto p : positions) {
+					if (p >= node.begin && p < node.end) {
+						result.push_back(p + shift);
+					}
+				}
+				return result;
+			};
+
+			for (auto p = node.begin; p < node.end; ++p) {
+				const auto mask = bytes[p];
+				bytes.push_back(mask);
+				follow.push_back(shifted(follow[p]));
+			}
+			return {shifted(node.first), shifted(node.last), node.nullable, node.begin + shift, node.end + shift};
+		}
+
+		constexpr size_t size(const Node& node) const { return node.end - node.begin; }
+
+	private:
+		constexpr void link_(const Positions_& from, const Positions_& to) {
+			for (auto p : from) {
+				follow[p] = union_(follow[p], to);
+			}
+		}
+
+		// Fragments are joined only to adjacent ones, so the union of their ranges is a range
+		static constexpr void span_(Node& result, const Node& a, const Node& b) {
+			if (a.begin == a.end) {
+				result.begin = b.begin;
+				result.end = b.end;
+			} else if (b.begin == b.end) {
+				result.begin = a.begin;
+				result.end = a.end;
+			} else {
+				result.begin = std::min(a.begin, b.begin);
+				result.end = std::max(a.end, b.end);
+			}
+		}
+	};
+
+	std::vector<ByteMask> bytes_;
+	std::vector<Positions_> follow_;
+	std::vector<bool> final_;
+
+	std::array<uint32_t, 256> class_map_ = {};
+	size_t class_count_ = 0;
+
+	// State 0 is dead, rows of table_ are states, columns are classes
+	std::vector<uint32_t> table_;
+	std::vector<bool> accepting_;
+	size_t state_count_ = 0;
+	uint32_t initial_state_ = 0;
+
+	constexpr StaticCompiler(std::string_view pattern, size_t max_states) {
+		Glushkov_ glushkov;
+		const auto regex = RegexGrammar<Glushkov_>{glushkov}.parse(pattern);
+
+		bytes_ = std::move(glushkov.bytes);
+		follow_ = std::move(glushkov.follow);
+		follow_[0] = regex.first;
+		final_.assign(bytes_.size(), false);
+		for (auto p : regex.last) {
+			final_[p] = true;
+		}
+		final_[0] = regex.nullable;
+
+		if (determinize_(max_states)) {
+			minimize_();
+			mergeClasses_();
+		}
+	}
+
+	// Byte classes from the positions' byte sets, then subsets of positions.
+	// Returns false if more than max_states states are needed
+	constexpr bool determinize_(size_t max_states) {
+		class_count_ = 1;
+		for (size_t p = 1; p < bytes_.size(); ++p) {
+			// (old class, in set) -> new class
+			std::array<uint32_t, 512> split = {};
+			uint32_t count = 0;
+			for (size_t b = 0; b < 256; ++b) {
+				auto& id = split[class_map_[b] * 2 + bytes_[p].test(b)];
+				if (id == 0) {
+					id = ++count;
+				}
+				class_map_[b] = id - 1;
+			}
+			class_count_ = count;
+		}
+
+		std::vector<uint32_t> representative(class_count_);
+		for (size_t b = 256; b-- > 0;) {
+			representative[class_map_[b]] = static_cast<uint32_t>(b);
+		}
+
+		std::vector<Positions_> subsets = {{}, {0}};
+		initial_state_ = 1;
+		for (size_t state = 1; state < subsets.size(); ++state) {
+			if (subsets.size() > max_states) {
+				state_count_ = max_states + 1;
+				return false;
+			}
+
+			table_.resize(subsets.size() * class_count_, 0);
+			for (size_t id = 0; id < class_count_; ++id) {
+				Positions_ next;
+				for (auto p : subsets[state]) {
+					for (auto q : follow_[p]) {
+						if (bytes_[q].test(representative[id])) {
+							next.push_back(q);
+						}
+					}
+				}
+				std::sort(next.begin(), next.end());
+				next.erase(std::unique(next.begin(), next.end()), next.end());
+
+				const auto it = std::find(subsets.begin(), subsets.end(), next);
+				table_[state * class_count_ + id] = static_cast<uint32_t>(it - subsets.begin());
+				if (it == subsets.end()) {
+					subsets.push_back(std::move(next));
+				}
+			}
+		}
+		if (subsets.size() > max_states) {
+			state_count_ = max_states + 1;
+			return false;
+		}
+		table_.resize(subsets.size() * class_count_, 0);
+
+		state_count_ = subsets.size();
+		accepting_.assign(state_count_, false);
+		for (size_t state = 0; state < state_count_; ++state) {
+			accepting_[state] = std::any_of(subsets[state].begin(), subsets[state].end(), [&](auto p) { return final_[p]; });
+		}
+
+		return true;
+	}
+
+	// Moore's partition refinement, the block of the dead state becomes state 0
+	constexpr void minimize_() {
+		std::vector<uint32_t> block(state_count_);
+		for (size_t state = 0; state < state_count_; ++state) {
+			block[state] = accepting_[state] != accepting_[0];
+		}
+
+		for (size_t count = 0;;) {
+			// Signature of a state: its block and the blocks of its successors
+			std::vector<std::vector<uint32_t>> signatures;
+			std::vector<uint32_t> next_block(state_count_);
+			for (size_t state = 0; state < state_count_; ++state) {
+				std::vector<uint32_t> signature = {block[state]};
+				for (size_t id = 0; id < class_count_; ++id) {
+					signature.push_back(block[table_[state * class_count_ + id]]);
+				}
+
+				const auto it = std::find(signatures.begin(), signatures.end(), signature);
+				next_block[state] = static_cast<uint32_t>(it - signatures.begin());
+				if (it == signatures.end()) {
+					signatures.push_back(std::move(signature));
+				}
+			}
+
+			block = std::move(next_block);
+			if (signatures.size() == count) {
+				break;
+			}
+			count = signatures.size();
+		}
+
+		const auto count = static_cast<size_t>(*std::max_element(block.begin(), block.end())) + 1;
+		std::vector<uint32_t> table(count * class_count_);
+		std::vector<bool> accepting(count);
+		for (size_t state = 0; state < state_count_; ++state) {
+			for (size_t id = 0; id < class_count_; ++id) {
+				table[block[state] * class_count_ + id] = block[table_[state * class_count_ + id]];
+			}
+			accepting[block[state]] = accepting_[state];
+		}
+
+		table_ = std::move(table);
+		accepting_ = std::move(accepting);
+		state_count_ = count;
+		initial_state_ = block[initial_state_];
+	}
+
+	// Classes whose columns became equal after minimization are merged
+	constexpr void mergeClasses_() {
+		const auto column_equal = [&](size_t a, size_t b) {
+			for (size_t state = 0; state < state_count_; ++state) {
+				if (table_[state * class_count_ + a] != table_[state * class_count_ + b]) {
+					return false;
+				}
+			}
+			return true;
+		};
+
+		std::vector<uint32_t> merged(class_count_);
+		std::vector<uint32_t> kept;
+		for (size_t id = 0; id < class_count_; ++id) {
+			const auto it = std::find_if(kept.begin(), kept.end(), [&](auto other) { return column_equal(id, other); });
+			merged[id] = static_cast<uint32_t>(it - kept.begin());
+			if (it == kept.end()) {
+				kept.push_back(static_cast<uint32_t>(id));
+			}
+		}
+
+		std::vector<uint32_t> table(state_count_ * kept.size());
+		for (size_t state = 0; state < state_count_; ++state) {
+			for (size_t id = 0; id < kept.size(); ++id) {
+				table[state * kept.size() + id] = table_[state * class_count_ + kept[id]];
+			}
+		}
+		for (auto& id : class_map_) {
+			id = merged[id];
+		}
+
+		table_ = std::move(table);
+		class_count_ = kept.size();
+	}
+};
+
+
+// DFA of a pattern known at compile time. The table is a constant of the
+// program, matching needs no construction and inlines into the caller:
+//   StaticAutomaton<"(a|b)*abb">::accept(s)
+// A pattern whose subset construction needs more than MaxStates states
+// fails the build.
+template <FixedString Pattern, size_t MaxStates = 256>
+class StaticAutomaton {
+	static constexpr auto kShape = StaticCompiler::shape(Pattern.view(), MaxStates);
+	static_assert(kShape.state_count <= MaxStates, "[StaticAutomaton] Pattern needs more DFA states than MaxStates");
+
+	static constexpr auto kTable = StaticCompiler::table<std::min(kShape.state_count, MaxStates), kShape.class_count>(Pattern.view(), MaxStates);
+
+public:
+	using StateId = typename decltype(kTable)::StateId;
+
+	static constexpr StateId kDeadState = 0;
+
+	static constexpr size_t stateCount() noexcept { return kShape.state_count; }
+	static constexpr size_t classCount() noexcept { return kShape.class_count; }
+	static constexpr StateId initialState() noexcept { return kTable.initial_state; }
+
+	static constexpr StateId next(StateId state, char c) noexcept {
+		return kTable.table[state * kShape.class_count + kTable.class_map[static_cast<unsigned char>(c)]];
+	}
+
+	static constexpr bool isAccepting(StateId state) noexcept { return kTable.accepting[state]; }
+
+	static constexpr StateId run(StateId state, std::string_view s) noexcept {
+		for (auto c : s) {
+			state = next(state, c);
+		}
+		return state;
+	}
+
+	static constexpr bool accept(std::string_view s) noexcept { return isAccepting(run(kTable.initial_state, s)); }
+};
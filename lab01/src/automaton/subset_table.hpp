@@ -0,0 +1,103 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include <types/common.hpp>
+#include <utils/hash_utils.hpp>
+
+
+// Sorted set of dense NFA state (or position) ids
+using Subset = std::vector<uint32_t>;
+
+// Interns subsets as dense DFA state ids handed out in discovery order,
+// so the table doubles as the worklist of subset construction.
+class SubsetTable {
+public:
+	using StateId = uint32_t;
+
+	// Returns id of subset and true if subset was not seen before
+	std::pair<StateId, bool> intern(Subset subset) {
+		auto [it, inserted] = ids_.try_emplace(std::move(subset), static_cast<StateId>(subsets_.size()));
+		if (inserted) {
+			subsets_.push_back(&it->first);
+		}
+		return {it->second, inserted};
+	}
+
+	// Returns id of subset if it was interned before
+	std::optional<StateId> find(const Subset& subset) const {
+		const auto it = ids_.find(subset);
+		if (it == ids_.end()) {
+			return std::nullopt;
+		}
+		return it->second;
+	}
+
+	const Subset& operator[](StateId id) const { return *subsets_[id]; }
+	size_t size() const { return subsets_.size(); }
+
+	void clear() {
+		subsets_.clear();
+		ids_.clear();
+	}
+
+private:
+	std::vector<const Subset*> subsets_;
+	UMap<Subset, StateId, HashUtils::VectorHash<uint32_t>> ids_;
+};
+
+// SubsetTable for parallel subset construction: intern may be called from many
+// threads at once. Subsets are spread over independently locked shards and ids
+// come from a shared counter, so they are dense but their order depends on
+// scheduling. Subsets interned since the last publish are not yet visible to
+// operator[] and size().
+class ConcurrentSubsetTable {
+public:
+	using StateId = uint32_t;
+
+	static constexpr size_t kShards = 64;
+
+	// Returns id of subset and true if subset was not seen before. Thread-safe
+	std::pair<StateId, bool> intern(Subset subset) {
+		auto& shard = shards_[HashUtils::VectorHash<uint32_t>{}(subset) % kShards];
+		std::lock_guard lock{shard.mutex};
+		auto [it, inserted] = shard.ids.try_emplace(std::move(subset), 0);
+		if (inserted) {
+			it->second = next_id_.fetch_add(1, std::memory_order_relaxed);
+			shard.fresh.emplace_back(it->second, &it->first);
+		}
+		return {it->second, inserted};
+	}
+
+	// Makes every interned subset visible; must not run concurrently with intern
+	void publish() {
+		subsets_.resize(next_id_.load(std::memory_order_relaxed));
+		for (auto& shard : shards_) {
+			for (auto [id, subset] : shard.fresh) {
+				subsets_[id] = subset;
+			}
+			shard.fresh.clear();
+		}
+	}
+
+	const Subset& operator[](StateId id) const { return *subsets_[id]; }
+	size_t size() const { return subsets_.size(); }
+
+private:
+	struct Shard {
+		std::mutex mutex;
+		UMap<Subset, StateId, HashUtils::VectorHash<uint32_t>> ids;
+		std::vector<std::pair<StateId, const Subset*>> fresh;  // interned since the last publish
+	};
+
+	std::array<Shard, kShards> shards_;
+	std::atomic<StateId> next_id_ = 0;
+	std::vector<const Subset*> subsets_;
+};
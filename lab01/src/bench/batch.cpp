@@ -0,0 +1,117 @@
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <bench/common.hpp>
+
+
+namespace {
+
+constexpr size_t kKeys = 1 << 20;
+constexpr size_t kRepeats = 5;
+
+std::string sRandomWord(std::mt19937& rng, std::string_view letters, size_t min_size, size_t max_size) {
+	std::string word(min_size + rng() % (max_size - min_size + 1), ' ');
+	for (auto& c : word) {
+		c = letters[rng() % letters.size()];
+	}
+	return word;
+}
+
+// Deterministic trie built directly, skipping regex compilation
+FiniteAutomaton sTrie(const std::vector<std::string>& words) {
+	States states = {""};
+	Transitions transitions;
+	for (auto&& word : words) {
+		for (size_t i = 0; i < word.size(); ++i) {
+			states.insert(word.substr(0, i + 1));
+			transitions[word.substr(0, i)][word[i]] = {word.substr(0, i + 1)};
+		}
+	}
+
+	Alphabet alphabet;
+	for (auto c : std::string_view{"abcdefghijklmnopqrstuvwxyz"}) {
+		alphabet.insert(c);
+	}
+
+	return FiniteAutomaton{std::move(states), std::move(alphabet), std::move(transitions), "", States(words.begin(), words.end())};
+}
+
+void sRun(const char* family, const CompiledAutomaton& matcher, const std::vector<std::string>& keys) {
+	const std::vector<std::string_view> views(keys.begin(), keys.end());
+
+	auto scalar = std::make_unique<bool[]>(keys.size());
+	const auto scalar_time = Bench::measure([&] {
+		for (size_t r = 0; r < kRepeats; ++r) {
+			for (size_t i = 0; i < views.size(); ++i) {
+				scalar[i] = matcher.accept(views[i]);
+			}
+		}
+	});
+
+	auto batch = std::make_unique<bool[]>(keys.size());
+	const auto batch_time = Bench::measure([&] {
+		for (size_t r = 0; r < kRepeats; ++r) {
+			matcher.acceptBatch(views, {batch.get(), views.size()});
+		}
+	});
+
+	size_t matched = 0;
+	for (size_t i = 0; i < keys.size(); ++i) {
+		if (scalar[i] != batch[i]) {
+			std::printf("%s: mismatch on key %zu \"%s\"\n", family, i, keys[i].c_str());
+			return;
+		}
+		matched += scalar[i];
+	}
+
+	const auto keys_per_second = [&](double seconds) { return static_cast<double>(keys.size() * kRepeats) / seconds; };
+	std::printf("%-12s %8zu %12.0f %12.0f %8.2fx %10zu\n", family, matcher.stateCount(), keys_per_second(scalar_time), keys_per_second(batch_time), scalar_time / batch_time, matched);
+}
+
+}  // namespace
+
+
+int main() {
+	std::mt19937 rng(42);
+
+#if defined(__AVX2__)
+	std::printf("batch: %zu lanes, AVX2 gather\n\n", CompiledAutomaton::kBatchLanes);
+#else
+	std::printf("batch: %zu lanes, scalar\n\n", CompiledAutomaton::kBatchLanes);
+#endif
+	std::printf("%-12s %8s %12s %12s %9s %10s\n", "family", "states", "scalar", "batch", "speedup", "matched");
+
+	{
+		// Small table that stays in L1
+		auto dfa = DeterministicFiniteAutomaton{"(a|b|c|d)*(ab|cd)(a|b|c|d)*"};
+		dfa.minimize();
+
+		std::vector<std::string> keys(kKeys);
+		for (auto& key : keys) {
+			key = sRandomWord(rng, "abcd", 4, 32);
+		}
+		sRun("small", dfa.compile(), keys);
+	}
+
+	for (size_t dictionary_size : {size_t{1000}, size_t{100000}}) {
+		// Trie of random words, the large one does not fit in cache
+		std::vector<std::string> words(dictionary_size);
+		for (auto& word : words) {
+			word = sRandomWord(rng, "abcdefghijklmnopqrstuvwxyz", 6, 12);
+		}
+
+		const auto matcher = CompiledAutomaton{sTrie(words)};
+
+		std::vector<std::string> keys(kKeys);
+		for (auto& key : keys) {
+			key = rng() % 4 ? words[rng() % words.size()] : sRandomWord(rng, "abcdefghijklmnopqrstuvwxyz", 6, 12);
+		}
+
+		const auto family = "trie/" + std::to_string(dictionary_size);
+		sRun(family.c_str(), matcher, keys);
+	}
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+
+#include <automaton/deterministic_finite_automaton.hpp>
+
+
+namespace Bench {
+
+// Runs f once and returns wall time in seconds
+template <typename F>
+double measure(F&& f) {
+	const auto start = std::chrono::steady_clock::now();
+	f();
+	const auto finish = std::chrono::steady_clock::now();
+	return std::chrono::duration<double>(finish - start).count();
+}
+
+inline std::string repeat(const std::string& s, size_t n) {
+	std::string result;
+	for (size_t i = 0; i < n; ++i) {
+		result += s;
+	}
+	return result;
+}
+
+}  // namespace Bench
@@ -0,0 +1,123 @@
+#include <cstdio>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <automaton/static_automaton.hpp>
+#include <bench/common.hpp>
+
+
+// Generated at build time by lab01_codegen, see lab01_generate_scanner in CMakeLists.txt
+bool directAbb(std::string_view s) noexcept;
+bool directDate(std::string_view s) noexcept;
+bool directIdentifier(std::string_view s) noexcept;
+bool directKeyword(std::string_view s) noexcept;
+
+
+namespace {
+
+constexpr size_t kKeys = 1 << 20;
+constexpr size_t kRepeats = 5;
+constexpr size_t kTextSize = size_t{64} << 20;
+
+// Same patterns as in CMakeLists.txt
+constexpr FixedString kAbb = "(a|b|c)*abb(a|b|c)*";
+constexpr FixedString kDate = "[0-9]{4}-[0-9]{2}-[0-9]{2}";
+constexpr FixedString kIdentifier = "[A-Za-z_][A-Za-z0-9_]*";
+constexpr FixedString kKeyword = "if|else|while|for|return|break|continue|switch|case|default";
+
+std::string sRandomWord(std::mt19937& rng, std::string_view letters, size_t min_size, size_t max_size) {
+	std::string word(min_size + rng() % (max_size - min_size + 1), ' ');
+	for (auto& c : word) {
+		c = letters[rng() % letters.size()];
+	}
+	return word;
+}
+
+// Matches every input kRepeats times with each matcher, prints inputs per second
+template <FixedString Pattern, typename Direct>
+void sRun(const char* family, const std::vector<std::string>& inputs, Direct direct) {
+	auto dfa = DeterministicFiniteAutomaton{Pattern.view()};
+	dfa.minimize();
+	const auto table = dfa.compile();
+
+	auto measure = [&](auto&& accept, size_t& matched) {
+		return Bench::measure([&] {
+			for (size_t r = 0; r < kRepeats; ++r) {
+				for (auto&& input : inputs) {
+					matched += accept(input);
+				}
+			}
+		});
+	};
+
+	size_t table_matched = 0;
+	size_t static_matched = 0;
+	size_t direct_matched = 0;
+	const auto table_time = measure([&](std::string_view s) { return table.accept(s); }, table_matched);
+	const auto static_time = measure([](std::string_view s) { return StaticAutomaton<Pattern>::accept(s); }, static_matched);
+	const auto direct_time = measure(direct, direct_matched);
+
+	if (table_matched != direct_matched || table_matched != static_matched) {
+		std::printf("%s: matchers disagree (%zu, %zu, %zu)\n", family, table_matched, static_matched, direct_matched);
+		return;
+	}
+
+	size_t bytes = 0;
+	for (auto&& input : inputs) {
+		bytes += input.size();
+	}
+
+	const auto per_second = [&](double seconds) { return static_cast<double>(inputs.size() * kRepeats) / seconds / 1e6; };
+	const auto megabytes_per_second = [&](double seconds) { return static_cast<double>(bytes * kRepeats) / seconds / 1e6; };
+	std::printf(
+		"%-12s %7zu %10.1f %10.1f %10.1f %9.0f %9.0f %9.0f %7.2fx\n",
+		family, table.stateCount(), per_second(table_time), per_second(static_time), per_second(direct_time),
+		megabytes_per_second(table_time), megabytes_per_second(static_time), megabytes_per_second(direct_time), table_time / direct_time
+	);
+}
+
+}  // namespace
+
+
+int main() {
+	std::mt19937 rng(42);
+
+	std::printf("inputs: M/s, bytes: MB/s\n\n");
+	std::printf(
+		"%-12s %7s %10s %10s %10s %9s %9s %9s %8s\n",
+		"family", "states", "table", "static", "direct", "table", "static", "direct", "speedup"
+	);
+
+	{
+		// One long text, the hot loop is a single state
+		std::vector<std::string> text = {sRandomWord(rng, "abc", kTextSize, kTextSize)};
+		sRun<kAbb>("abb/text", text, directAbb);
+	}
+
+	{
+		std::vector<std::string> keys(kKeys);
+		for (auto& key : keys) {
+			key = sRandomWord(rng, "0123456789", 4, 4) + "-" + sRandomWord(rng, "0123456789", 2, 2) + (rng() % 4 ? "-" : "/") + sRandomWord(rng, "0123456789", 2, 2);
+		}
+		sRun<kDate>("date", keys, directDate);
+	}
+
+	{
+		std::vector<std::string> keys(kKeys);
+		for (auto& key : keys) {
+			key = sRandomWord(rng, "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_-", 4, 24);
+		}
+		sRun<kIdentifier>("identifier", keys, directIdentifier);
+	}
+
+	{
+		const std::vector<std::string> words = {"if", "else", "while", "for", "return", "break", "continue", "switch", "case", "default"};
+		std::vector<std::string> keys(kKeys);
+		for (auto& key : keys) {
+			key = rng() % 2 ? words[rng() % words.size()] : sRandomWord(rng, "abcdefghilnorstuw", 2, 8);
+		}
+		sRun<kKeyword>("keyword", keys, directKeyword);
+	}
+}
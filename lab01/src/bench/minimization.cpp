@@ -0,0 +1,76 @@
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <bench/common.hpp>
+
+
+namespace {
+
+// Brzozowski's path takes seconds beyond these sizes
+constexpr size_t kBrzozowskiMaxNth = 12;
+constexpr size_t kBrzozowskiMaxRandom = 16;
+
+// (a|b)^n a (a|b)*: minimal DFA has n + 2 states, its reversal determinizes to 2^n
+DeterministicFiniteAutomaton sNthSymbolFromStart(size_t n) {
+	return DeterministicFiniteAutomaton{Bench::repeat("(a|b)", n) + "a(a|b)*"};
+}
+
+// Random complete DFA over {a, b, c}
+DeterministicFiniteAutomaton sRandom(size_t n, std::mt19937& rng) {
+	States states;
+	for (size_t i = 0; i < n; ++i) {
+		states.insert(std::to_string(i));
+	}
+
+	Transitions transitions;
+	States accept_states;
+	for (size_t i = 0; i < n; ++i) {
+		for (auto a : {'a', 'b', 'c'}) {
+			transitions[std::to_string(i)][a] = {std::to_string(rng() % n)};
+		}
+		if (rng() % 2) {
+			accept_states.insert(std::to_string(i));
+		}
+	}
+
+	return DeterministicFiniteAutomaton{FiniteAutomaton{std::move(states), {'a', 'b', 'c'}, std::move(transitions), "0", std::move(accept_states)}};
+}
+
+void sRun(const char* family, size_t parameter, const DeterministicFiniteAutomaton& dfa, bool run_brzozowski) {
+	auto hopcroft = dfa;
+	const auto hopcroft_time = Bench::measure([&] { hopcroft.minimize(); });
+
+	std::printf("%-20s %8zu %10zu %12.3f %10zu", family, parameter, dfa.states().size(), hopcroft_time * 1e3, hopcroft.states().size());
+
+	if (run_brzozowski) {
+		size_t states = 0;
+		const auto brzozowski_time = Bench::measure([&] { states = DeterministicFiniteAutomaton::brzozowski(dfa).states().size(); });
+		std::printf(" %14.3f %12zu\n", brzozowski_time * 1e3, states);
+	} else {
+		std::printf(" %14s %12s\n", "skipped", "-");
+	}
+}
+
+}  // namespace
+
+
+int main() {
+	std::setvbuf(stdout, nullptr, _IOLBF, 0);
+
+	std::printf("%-20s %8s %10s %12s %10s %14s %12s\n", "family", "n", "states", "hopcroft_ms", "h_states", "brzozowski_ms", "b_states");
+
+	for (int parameter : {4, 8, 10, 12, 14, 16, 20, 64, 256}) {
+		const auto n = static_cast<size_t>(parameter);
+		const auto dfa = sNthSymbolFromStart(n);
+		sRun("nth-from-start", n, dfa, n <= kBrzozowskiMaxNth);
+	}
+
+	std::mt19937 rng(42);
+	for (int parameter : {8, 16, 24, 256, 1024, 4096}) {
+		const auto n = static_cast<size_t>(parameter);
+		const auto dfa = sRandom(n, rng);
+		sRun("random", n, dfa, n <= kBrzozowskiMaxRandom);
+	}
+}
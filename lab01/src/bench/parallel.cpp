@@ -0,0 +1,84 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <bench/common.hpp>
+
+
+namespace {
+
+// (a|b)*a(a|b)^n determinizes to 2^(n + 1) states
+constexpr size_t kRegexBlowup = 16;
+
+// Pruning of the 2^n named states takes seconds beyond this
+constexpr size_t kFaBlowup = 12;
+
+double sPhase(const BuildStatistics& statistics, const std::string& name) {
+	for (auto&& phase : statistics.phases) {
+		if (phase.name == name) {
+			return phase.seconds;
+		}
+	}
+	return 0;
+}
+
+void sRun(const char* family, const std::vector<size_t>& threads, const std::function<DeterministicFiniteAutomaton(const BuildOptions&)>& build) {
+	double serial_time = 0;
+	for (auto t : threads) {
+		size_t states = 0;
+		BuildStatistics statistics;
+		const auto total_time = Bench::measure([&] {
+			const auto dfa = build({.collect_statistics = true, .threads = t});
+			states = dfa.states().size();
+			statistics = *dfa.statistics();
+		});
+
+		const auto subset_time = sPhase(statistics, "subset construction");
+		if (t == 1) {
+			serial_time = subset_time;
+		}
+
+		std::printf(
+			"%-14s %8zu %10zu %12.1f %12.1f %8.2fx\n",
+			family, t, states, subset_time * 1e3, total_time * 1e3, serial_time / subset_time
+		);
+	}
+}
+
+}  // namespace
+
+
+// Usage: lab01_bench_parallel [max threads]
+// Times subset construction on 1, 2, 4, ... up to max threads (hardware threads by default)
+int main(int argc, char* argv[]) {
+	std::setvbuf(stdout, nullptr, _IOLBF, 0);
+	const auto max_threads = argc > 1
+		? static_cast<size_t>(std::strtoul(argv[1], nullptr, 10))
+		: std::max<size_t>(1, std::thread::hardware_concurrency());
+
+	std::vector<size_t> threads;
+	for (size_t t = 1; t < max_threads; t *= 2) {
+		threads.push_back(t);
+	}
+	threads.push_back(max_threads);
+
+	std::printf("hardware threads: %u\n\n", std::thread::hardware_concurrency());
+	std::printf("%-14s %8s %10s %12s %12s %9s\n", "family", "threads", "states", "subset_ms", "total_ms", "speedup");
+
+	const auto blowup = "(a|b)*a" + Bench::repeat("(a|b)", kRegexBlowup);
+	sRun("blowup/regex", threads, [&](const BuildOptions& options) {
+		return DeterministicFiniteAutomaton{blowup, options};
+	});
+
+	// Reversal of the minimal DFA of (a|b)^n a (a|b)*: an NFA with λ-transitions, 2^n subsets
+	auto nth = DeterministicFiniteAutomaton{Bench::repeat("(a|b)", kFaBlowup) + "a(a|b)*"};
+	nth.minimize();
+	const auto reversed = nth.reversed();
+	sRun("blowup/fa", threads, [&](const BuildOptions& options) {
+		return DeterministicFiniteAutomaton{reversed, options};
+	});
+}
@@ -0,0 +1,90 @@
+#include <cstdio>
+#include <random>
+#include <string>
+#include <utility>
+
+#include <automaton/deterministic_finite_automaton.hpp>
+#include <automaton/position_automaton.hpp>
+#include <bench/common.hpp>
+#include <parser/abstract_syntax_tree.hpp>
+#include <parser/recursive_descent_parser.hpp>
+
+
+namespace {
+
+// Machine-generated shapes, each grown to about size characters
+
+std::string sLiterals(std::mt19937& rng, size_t size) {
+	std::string result;
+	while (result.size() < size) {
+		if (!result.empty()) {
+			result += '|';
+		}
+		for (size_t i = 6 + rng() % 7; i > 0; --i) {
+			result += static_cast<char>('a' + rng() % 26);
+		}
+	}
+	return result;
+}
+
+std::string sNesting(std::mt19937&, size_t size) {
+	return std::string(size / 2, '(') + "a" + std::string(size / 2, ')');
+}
+
+std::string sNestedAlternation(std::mt19937&, size_t size) {
+	return Bench::repeat("(a|", size / 4) + "b" + std::string(size / 4, ')');
+}
+
+std::string sSequence(std::mt19937&, size_t size) {
+	return Bench::repeat("(ab|c)*d", size / 8);
+}
+
+void sRun(const char* family, const std::string& expression) {
+	AbstractSyntaxTreeArena arena;
+	NodeId root = kNoNode;
+	const auto parse_time = Bench::measure([&] {
+		const auto regex = RecursiveDescentParser{}.parse(expression, arena);
+		root = arena.create({NodeKind::Cat}, regex, arena.create({NodeKind::EndMarker}));
+	});
+
+	size_t positions = 0;
+	const auto nodes = arena.size();
+	const auto analysis_time = Bench::measure([&] {
+		auto ast = AbstractSyntaxTree{std::move(arena), root};
+		positions = ast.indexToLeaf().size() - 1;
+	});
+
+	const auto automaton_time = Bench::measure([&] { PositionAutomaton{{expression}}; });
+
+	size_t dfa_states = 0;
+	const auto dfa_time = Bench::measure([&] { dfa_states = DeterministicFiniteAutomaton{expression}.states().size(); });
+
+	const auto ns_per_char = [&](double seconds) { return seconds * 1e9 / static_cast<double>(expression.size()); };
+	std::printf("%-18s %9zu %9zu %9zu %10.1f %10.1f %18.1f %10.1f %10zu\n", family, expression.size(), nodes, positions, ns_per_char(parse_time), ns_per_char(analysis_time), ns_per_char(automaton_time), ns_per_char(dfa_time), dfa_states);
+}
+
+}  // namespace
+
+
+int main() {
+	std::setvbuf(stdout, nullptr, _IOLBF, 0);
+
+	std::mt19937 rng(42);
+
+	std::printf("times in ns per pattern character, position_automaton = parse + analysis + followpos tables,\n");
+	std::printf("dfa = position_automaton + subset construction\n\n");
+	std::printf("%-18s %9s %9s %9s %10s %10s %18s %10s %10s\n", "family", "chars", "nodes", "positions", "parse", "analysis", "position_automaton", "dfa", "dfa_states");
+
+	const std::pair<const char*, std::string (*)(std::mt19937&, size_t)> families[] = {
+		{"literals", sLiterals},
+		{"nesting", sNesting},
+		{"nested-alternation", sNestedAlternation},
+		{"sequence", sSequence},
+	};
+
+	for (auto&& [family, generate] : families) {
+		for (size_t size : {size_t{100000}, size_t{300000}, size_t{1000000}}) {
+			sRun(family, generate(rng, size));
+		}
+	}
+}
@@ -0,0 +1,192 @@
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <optional>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <bench/common.hpp>
+#include <parser/abstract_syntax_tree.hpp>
+#include <parser/recursive_descent_parser.hpp>
+#include <utils/json_writer.hpp>
+
+
+namespace {
+
+constexpr size_t kTextSize = size_t{16} << 20;
+
+// Brzozowski's first reversal determinizes to 2^n states on the blowup family
+constexpr size_t kBrzozowskiMaxBlowup = 12;
+
+struct Family {
+	const char* name;
+	std::vector<size_t> parameters;
+	std::function<std::string(size_t, std::mt19937&)> pattern;
+	std::string_view alphabet;  // of the text matched in the accept stage
+	size_t brzozowski_max;      // parameter above which brzozowski is skipped
+};
+
+std::string sRandomWord(std::mt19937& rng, std::string_view letters, size_t size) {
+	std::string word(size, ' ');
+	for (auto& c : word) {
+		c = letters[rng() % letters.size()];
+	}
+	return word;
+}
+
+size_t sTransitionCount(const FiniteAutomaton& fa) {
+	size_t count = 0;
+	for (auto&& [from, map_symbol_to_states] : fa.transitions()) {
+		for (auto&& [symbol, to_states] : map_symbol_to_states) {
+			count += to_states.size();
+		}
+	}
+	return count;
+}
+
+void sAutomaton(JsonWriter& json, const char* stage, double seconds, const FiniteAutomaton& fa) {
+	json.key(stage).beginObject();
+	json.key("ms").value(seconds * 1e3);
+	json.key("states").value(fa.states().size());
+	json.key("transitions").value(sTransitionCount(fa));
+	json.endObject();
+}
+
+void sRun(JsonWriter& json, const Family& family, size_t parameter, std::mt19937& rng) {
+	const auto pattern = family.pattern(parameter, rng);
+
+	json.beginObject();
+	json.key("family").value(family.name);
+	json.key("parameter").value(parameter);
+	json.key("pattern_bytes").value(pattern.size());
+	json.key("stages").beginObject();
+
+	// Parsing and position analysis on their own, as DeterministicFiniteAutomaton runs them too
+	AbstractSyntaxTreeArena arena;
+	NodeId root = kNoNode;
+	const auto parse_time = Bench::measure([&] {
+		const auto regex = RecursiveDescentParser{}.parse(pattern, arena);
+		root = arena.create({NodeKind::Cat}, regex, arena.create({NodeKind::EndMarker}));
+	});
+	const auto nodes = arena.size();
+	json.key("parse").beginObject().key("ms").value(parse_time * 1e3).key("nodes").value(nodes).endObject();
+
+	size_t positions = 0;
+	const auto analysis_time = Bench::measure([&] {
+		const auto ast = AbstractSyntaxTree{std::move(arena), root};
+		positions = ast.indexToLeaf().size() - 1;
+	});
+	json.key("analysis").beginObject().key("ms").value(analysis_time * 1e3).key("positions").value(positions).endObject();
+
+	// sBuildDfaFromRegex
+	std::optional<DeterministicFiniteAutomaton> dfa;
+	const auto regex_time = Bench::measure([&] { dfa.emplace(pattern); });
+	sAutomaton(json, "dfa_from_regex", regex_time, *dfa);
+
+	// Same construction again with the phases and counters broken down
+	{
+		auto instrumented = DeterministicFiniteAutomaton{pattern, {.collect_statistics = true}};
+		instrumented.minimize();
+		const auto compiled = instrumented.compile();
+		json.key("build_statistics");
+		compiled.statistics()->write(json);
+	}
+
+	// sBuildDfaFromFa on the reversal, the first step of Brzozowski's algorithm
+	const auto reversed = dfa->reversed();
+	std::optional<DeterministicFiniteAutomaton> reversed_dfa;
+	const auto fa_time = Bench::measure([&] { reversed_dfa.emplace(reversed); });
+	sAutomaton(json, "dfa_from_fa", fa_time, *reversed_dfa);
+
+	const auto run_brzozowski = parameter <= family.brzozowski_max;
+	std::optional<DeterministicFiniteAutomaton> minimal;
+	if (run_brzozowski) {
+		const auto brzozowski_time = Bench::measure([&] { minimal = DeterministicFiniteAutomaton::brzozowski(*dfa); });
+		sAutomaton(json, "brzozowski", brzozowski_time, *minimal);
+	} else {
+		minimal = *dfa;
+		minimal->minimize();
+	}
+
+	const auto matcher = minimal->compile();
+	const auto text = sRandomWord(rng, family.alphabet, kTextSize);
+	bool accepted = false;
+	const auto accept_time = Bench::measure([&] { accepted = matcher.accept(text); });
+	json.key("accept").beginObject();
+	json.key("mb_per_s").value(static_cast<double>(text.size()) / accept_time / 1e6);
+	json.key("states").value(matcher.stateCount());
+	json.key("classes").value(matcher.classCount());
+	json.key("accepted").value(accepted);
+	json.endObject();
+
+	json.endObject().endObject();
+
+	std::printf(
+		"%-12s %6zu %8zu %9.2f %9.2f %9.2f %8zu %9.2f %8zu %10s %9.0f\n",
+		family.name, parameter, pattern.size(), parse_time * 1e3, analysis_time * 1e3,
+		regex_time * 1e3, dfa->states().size(), fa_time * 1e3, reversed_dfa->states().size(),
+		run_brzozowski ? std::to_string(minimal->states().size()).c_str() : "skipped",
+		static_cast<double>(text.size()) / accept_time / 1e6
+	);
+}
+
+}  // namespace
+
+
+// Usage: lab01_bench_pipeline [output.json]
+// Times every stage of regex -> DFA on pattern families with known behaviour,
+// prints a table and writes the same results as JSON (lab01_bench_pipeline.json by default)
+int main(int argc, char* argv[]) {
+	std::setvbuf(stdout, nullptr, _IOLBF, 0);
+	const std::string output = argc > 1 ? argv[1] : "lab01_bench_pipeline.json";
+
+	const std::vector<Family> families = {
+		// Linear everywhere: one position per byte, a chain of states
+		{"literal", {100, 1000, 10000}, [](size_t n, std::mt19937& rng) { return sRandomWord(rng, "abcdefghijklmnopqrstuvwxyz", n); }, "abcdefghijklmnopqrstuvwxyz", SIZE_MAX},
+		// Trie-shaped DFA, large byte-class and transition counts
+		{"alternation", {100, 1000, 5000}, [](size_t n, std::mt19937& rng) {
+			std::string pattern = sRandomWord(rng, "abcdefghijklmnopqrstuvwxyz", 8);
+			for (size_t i = 1; i < n; ++i) {
+				pattern += "|" + sRandomWord(rng, "abcdefghijklmnopqrstuvwxyz", 8);
+			}
+			return pattern;
+		}, "abcdefghijklmnopqrstuvwxyz", 1000},
+		// (a|b)*a(a|b)^n: n + 2 positions, 2^(n + 1) DFA states
+		{"blowup", {4, 8, 12, 14}, [](size_t n, std::mt19937&) { return "(a|b)*a" + Bench::repeat("(a|b)", n); }, "ab", kBrzozowskiMaxBlowup},
+		// ((((a*b)*c)*d)*...): deep nesting, few states
+		{"nested-star", {5, 50, 200}, [](size_t n, std::mt19937&) {
+			std::string pattern = "a";
+			for (size_t i = 1; i <= n; ++i) {
+				pattern = "(" + pattern + "*" + static_cast<char>('a' + i % 26) + ")";
+			}
+			return pattern + "*";
+		}, "abcdefghijklmnopqrstuvwxyz", SIZE_MAX},
+	};
+
+	JsonWriter json;
+	json.beginObject();
+	json.key("benchmark").value("pipeline");
+	json.key("text_bytes").value(kTextSize);
+	json.key("results").beginArray();
+
+	std::printf(
+		"%-12s %6s %8s %9s %9s %9s %8s %9s %8s %10s %9s\n",
+		"family", "n", "bytes", "parse_ms", "ast_ms", "regex_ms", "states", "fa_ms", "states", "brzozowski", "MB/s"
+	);
+
+	std::mt19937 rng(42);
+	for (auto&& family : families) {
+		for (auto parameter : family.parameters) {
+			sRun(json, family, parameter, rng);
+		}
+	}
+
+	json.endArray();
+	json.endObject();
+
+	std::ofstream{output} << json.str() << "\n";
+	std::printf("\nwritten to %s\n", output.c_str());
+}
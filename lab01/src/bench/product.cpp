@@ -0,0 +1,81 @@
+#include <cstdio>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <automaton/product_automaton.hpp>
+#include <bench/common.hpp>
+
+
+namespace {
+
+constexpr size_t kRules = 100;
+
+std::string sRandomWord(std::mt19937& rng, std::string_view letters, size_t min_size, size_t max_size) {
+	std::string word(min_size + rng() % (max_size - min_size + 1), ' ');
+	for (auto& c : word) {
+		c = letters[rng() % letters.size()];
+	}
+	return word;
+}
+
+// Path-like rules such as "/api/(user|admin)/[a-z]*\.json", many of them overlap
+std::string sRule(std::mt19937& rng) {
+	std::string rule = "/" + sRandomWord(rng, "ab", 1, 2);
+	for (size_t i = 0, parts = 2 + rng() % 4; i < parts; ++i) {
+		switch (rng() % 3) {
+			case 0: rule += "/" + sRandomWord(rng, "abc", 1, 3); break;
+			case 1: rule += "/(" + sRandomWord(rng, "abc", 1, 3) + "|" + sRandomWord(rng, "abc", 1, 3) + ")"; break;
+			default: rule += "/[a-c]*"; break;
+		}
+	}
+	return rule + (rng() % 2 ? "" : "(\\.json)?");
+}
+
+}  // namespace
+
+
+// Audits every ordered pair of kRules rules for a string matching the first but not the second,
+// once lazily and once materialising each reachable product before searching it
+int main() {
+	std::mt19937 rng(42);
+
+	std::vector<CompiledAutomaton> rules;
+	for (size_t i = 0; i < kRules; ++i) {
+		auto dfa = DeterministicFiniteAutomaton{sRule(rng)};
+		dfa.minimize();
+		rules.push_back(dfa.compile());
+	}
+
+	auto audit = [&](bool eager, size_t& overlaps, size_t& states) {
+		return Bench::measure([&] {
+			for (auto&& a : rules) {
+				for (auto&& b : rules) {
+					auto product = ProductAutomaton{a, b, ProductAutomaton::Operation::Difference};
+					if (eager) {
+						product.materialize();
+					}
+					overlaps += !product.isEmpty();
+					states += product.materializedStates();
+				}
+			}
+		});
+	};
+
+	size_t lazy_found = 0;
+	size_t lazy_states = 0;
+	size_t eager_found = 0;
+	size_t eager_states = 0;
+	const auto lazy_time = audit(false, lazy_found, lazy_states);
+	const auto eager_time = audit(true, eager_found, eager_states);
+
+	const auto pairs = static_cast<double>(kRules * kRules);
+	std::printf("%zu rules, %zu pairs, %zu with a witness\n\n", kRules, kRules * kRules, lazy_found);
+	std::printf("%-8s %12s %14s\n", "mode", "pairs/s", "pair states");
+	std::printf("%-8s %12.0f %14.1f\n", "lazy", pairs / lazy_time, static_cast<double>(lazy_states) / pairs);
+	std::printf("%-8s %12.0f %14.1f\n", "eager", pairs / eager_time, static_cast<double>(eager_states) / pairs);
+	if (lazy_found != eager_found) {
+		std::printf("lazy and eager disagree\n");
+	}
+}
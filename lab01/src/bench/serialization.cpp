@@ -0,0 +1,96 @@
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <bench/common.hpp>
+
+
+namespace {
+
+constexpr size_t kKeys = 1 << 20;
+
+std::string sRandomWord(std::mt19937& rng, size_t min_size, size_t max_size) {
+	std::string word(min_size + rng() % (max_size - min_size + 1), ' ');
+	for (auto& c : word) {
+		c = static_cast<char>('a' + rng() % 26);
+	}
+	return word;
+}
+
+// Startup cost of a rule set: building the matcher from regexes against mapping a saved image
+void sRun(size_t rule_count) {
+	std::mt19937 rng(42);
+	std::vector<std::string> rules(rule_count);
+	for (auto& rule : rules) {
+		rule = sRandomWord(rng, 4, 8) + (rng() % 2 ? "[0-9]+" : "(-[a-z]+)?");
+	}
+
+	std::optional<CompiledAutomaton> built;
+	const auto build_time = Bench::measure([&] {
+		auto dfa = DeterministicFiniteAutomaton{rules};
+		dfa.minimize();
+		built = dfa.compile();
+	});
+
+	const auto path = (std::filesystem::temp_directory_path() / "lab01_bench_serialization.dfa").string();
+	const auto save_time = Bench::measure([&] {
+		std::ofstream out{path, std::ios::binary};
+		built->save(out);
+	});
+	const auto size = static_cast<size_t>(std::filesystem::file_size(path));
+
+	std::optional<CompiledAutomaton> loaded;
+	const auto load_time = Bench::measure([&] { loaded = CompiledAutomaton::load(path); });
+	const auto trusted_time = Bench::measure([&] { loaded = CompiledAutomaton::load(path, false); });
+
+	std::vector<std::string> keys(kKeys);
+	for (auto& key : keys) {
+		key = rules[rng() % rules.size()];
+		key.erase(key.find_first_of("[("));
+		key += rng() % 2 ? std::to_string(rng() % 1000) : "-" + sRandomWord(rng, 1, 4);
+	}
+
+	size_t built_matched = 0;
+	const auto built_match_time = Bench::measure([&] {
+		for (auto&& key : keys) {
+			built_matched += built->accept(key);
+		}
+	});
+
+	size_t loaded_matched = 0;
+	const auto loaded_match_time = Bench::measure([&] {
+		for (auto&& key : keys) {
+			loaded_matched += loaded->accept(key);
+		}
+	});
+
+	if (built_matched != loaded_matched) {
+		std::printf("%zu rules: loaded automaton matched %zu keys, built one %zu\n", rule_count, loaded_matched, built_matched);
+	}
+
+	const auto keys_per_second = [](double seconds) { return static_cast<double>(kKeys) / seconds / 1e6; };
+	std::printf(
+		"%6zu %8zu %10zu %10.2f %8.2f %10.3f %10.3f %8.1f %8.1f\n",
+		rule_count, built->stateCount(), size, build_time * 1e3, save_time * 1e3, load_time * 1e3, trusted_time * 1e3,
+		keys_per_second(built_match_time), keys_per_second(loaded_match_time)
+	);
+
+	std::filesystem::remove(path);
+}
+
+}  // namespace
+
+
+int main() {
+	std::printf("times in ms, matching in Mkeys/s\n\n");
+	std::printf("%6s %8s %10s %10s %8s %10s %10s %8s %8s\n", "rules", "states", "bytes", "build", "save", "load", "trusted", "built", "mapped");
+
+	for (size_t rule_count : {size_t{100}, size_t{1000}, size_t{5000}}) {
+		sRun(rule_count);
+	}
+}
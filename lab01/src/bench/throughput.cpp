@@ -0,0 +1,101 @@
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+
+#include <automaton/static_automaton.hpp>
+#include <bench/common.hpp>
+#include <utils/mapped_file.hpp>
+
+
+namespace {
+
+constexpr FixedString kDefaultExpression = "(a|b|c)*abb(a|b|c)*";
+constexpr size_t kGeneratedSize = size_t{256} << 20;
+
+std::string sGenerateFile() {
+	const auto path = (std::filesystem::temp_directory_path() / "lab01_bench_throughput.txt").string();
+
+	std::mt19937 rng(42);
+	std::string data(kGeneratedSize, 'a');
+	for (auto& c : data) {
+		c = "abc"[rng() % 3];
+	}
+	std::ofstream{path, std::ios::binary}.write(data.data(), static_cast<std::streamsize>(data.size()));
+
+	return path;
+}
+
+void sReport(const char* mode, size_t bytes, double seconds, bool accepted) {
+	std::printf("%-16s %10.1f MB/s  accepted=%d\n", mode, static_cast<double>(bytes) / seconds / 1e6, accepted);
+}
+
+}  // namespace
+
+
+// Usage: lab01_bench_throughput [regex [file]]
+// Without a file matches a generated 256 MiB file of 'a', 'b' and 'c'
+int main(int argc, char* argv[]) {
+	if (argc > 3) {
+		std::fprintf(stderr, "usage: %s [regex [file]]\n", argv[0]);
+		return 1;
+	}
+
+	const std::string expression{argc > 1 ? argv[1] : kDefaultExpression.view()};
+	const auto path = argc > 2 ? std::string{argv[2]} : sGenerateFile();
+	const auto size = static_cast<size_t>(std::filesystem::file_size(path));
+
+	auto dfa = DeterministicFiniteAutomaton{expression};
+	dfa.minimize();
+	const auto matcher = dfa.compile();
+
+	std::printf("regex: %s\nfile: %s (%zu bytes)\nstates: %zu, classes: %zu\n\n", expression.c_str(), path.c_str(), size, matcher.stateCount(), matcher.classCount());
+
+	{
+		std::ifstream in{path, std::ios::binary};
+		const std::string data{std::istreambuf_iterator<char>{in}, {}};
+
+		bool accepted = false;
+		const auto time = Bench::measure([&] { accepted = matcher.accept(data); });
+		sReport("in-memory", size, time, accepted);
+
+		for (int count : {2, 4, 8}) {
+			const auto threads = static_cast<size_t>(count);
+			const auto parallel_time = Bench::measure([&] { accepted = matcher.acceptParallel(data, threads); });
+			const auto mode = "parallel/" + std::to_string(threads);
+			sReport(mode.c_str(), size, parallel_time, accepted);
+		}
+
+		// Same table built at compile time
+		if (expression == kDefaultExpression.view()) {
+			const auto static_time = Bench::measure([&] { accepted = StaticAutomaton<kDefaultExpression>::accept(data); });
+			sReport("static", size, static_time, accepted);
+		}
+	}
+
+	for (size_t buffer_size : {size_t{4} << 10, size_t{64} << 10, size_t{1} << 20}) {
+		bool accepted = false;
+		const auto time = Bench::measure([&] {
+			std::ifstream in{path, std::ios::binary};
+			auto stream = matcher.stream();
+			stream.feed(in, buffer_size);
+			accepted = stream.finish();
+		});
+
+		const auto mode = "read/" + std::to_string(buffer_size >> 10) + "K";
+		sReport(mode.c_str(), size, time, accepted);
+	}
+
+	{
+		bool accepted = false;
+		const auto time = Bench::measure([&] {
+			const MappedFile file{path};
+			auto stream = matcher.stream();
+			stream.feed(file.view());
+			accepted = stream.finish();
+		});
+		sReport("mmap", size, time, accepted);
+	}
+}
@@ -0,0 +1,30 @@
+#include <exception>
+#include <fstream>
+#include <iostream>
+
+#include <automaton/deterministic_finite_automaton.hpp>
+
+
+// Usage: lab01_codegen <function name> <regex> <output file>
+// Writes a direct-coded matcher of the minimal DFA of regex, see FiniteAutomaton::toCppFormat
+int main(int argc, char* argv[]) {
+	if (argc != 4) {
+		std::cerr << "Usage: " << argv[0] << " <function name> <regex> <output file>\n";
+		return 2;
+	}
+
+	try {
+		auto dfa = DeterministicFiniteAutomaton{argv[2]};
+		dfa.minimize();
+		const auto cpp = dfa.toCppFormat(argv[1]);
+
+		std::ofstream out{argv[3], std::ios::binary};
+		if (!out.write(cpp.data(), static_cast<std::streamsize>(cpp.size()))) {
+			std::cerr << "Cannot write " << argv[3] << "\n";
+			return 1;
+		}
+	} catch (const std::exception& e) {
+		std::cerr << e.what() << "\n";
+		return 1;
+	}
+}
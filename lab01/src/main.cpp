@@ -1,4 +1,6 @@
 #include <iostream>
+#include <string>
+#include <utility>
 
 #include <automaton/deterministic_finite_automaton.hpp>
 #include <parser/abstract_syntax_tree.hpp>
@@ -8,28 +10,6 @@
 
 namespace {
 
-DeterministicFiniteAutomaton sBrzozowski(const FiniteAutomaton& A) {
-	auto fa = A.reversed();
-	std::cout << "r(A):\n" << generateLinkToGraphvizOnline(fa.toDotFormat()) << std::endl;
-
-	auto dfa = DeterministicFiniteAutomaton(fa);
-	std::cout << "dr(A):\n" << generateLinkToGraphvizOnline(dfa.toDotFormat()) << std::endl;
-
-	dfa.rename();
-	std::cout << "mdr(A):\n" << generateLinkToGraphvizOnline(dfa.toDotFormat()) << std::endl;
-
-	fa = dfa.reversed();
-	std::cout << "rmdr(A):\n" << generateLinkToGraphvizOnline(fa.toDotFormat()) << std::endl;
-
-	dfa = DeterministicFiniteAutomaton(fa);
-	std::cout << "drmdr(A):\n" << generateLinkToGraphvizOnline(dfa.toDotFormat()) << std::endl;
-
-	dfa.rename();
-	std::cout << "mdrmdr(A):\n" << generateLinkToGraphvizOnline(dfa.toDotFormat()) << std::endl;
-
-	return dfa;
-}
-
 FiniteAutomaton sExample1() {
 	// from http://sovietov.com/txt/minfa/minfa.html
 
@@ -54,19 +34,21 @@ FiniteAutomaton sExample2() {
 		{"0", "1", "2", "3", "4", "5", "6", "7", "8", "9", "10"},
 		{'a', 'b'},
 		{
-			{"0", {{'L', {"1", "7"}}}},
-			{"1", {{'L', {"2", "4"}}}},
 			{"2", {{'a', {"3"}}}},
-			{"3", {{'L', {"6"}}}},
 			{"4", {{'b', {"5"}}}},
-			{"5", {{'L', {"6"}}}},
-			{"6", {{'L', {"1", "7"}}}},
 			{"7", {{'a', {"8"}}}},
 			{"8", {{'b', {"9"}}}},
 			{"9", {{'b', {"10"}}}},
 		},
 		"0",
-		{"10"}
+		{"10"},
+		{
+			{"0", {"1", "7"}},
+			{"1", {"2", "4"}},
+			{"3", {"6"}},
+			{"5", {"6"}},
+			{"6", {"1", "7"}},
+		}
 	};
 }
 
@@ -80,8 +62,10 @@ int main() {
 	std::cout << "Input regular expression\n>>> ";
 	std::cin >> expression;
 
-	auto root = RecursiveDescentParser{}.parse("(" + std::string{expression} + ")#");
-	auto ast = AbstractSyntaxTree{root};
+	AbstractSyntaxTreeArena arena;
+	const auto regex = RecursiveDescentParser{}.parse(expression, arena);
+	const auto root = arena.create({NodeKind::Cat}, regex, arena.create({NodeKind::EndMarker}));
+	auto ast = AbstractSyntaxTree{std::move(arena), root};
 	std::cout << "AST:\n" << generateLinkToGraphvizOnline(ast.toDotFormat()) << std::endl;
 
 	DeterministicFiniteAutomaton dfa(expression);
@@ -96,7 +80,10 @@ int main() {
 		std::cout << "A = m(A):\n" << generateLinkToGraphvizOnline(dfa.toDotFormat()) << std::endl;
 	}
 
-	dfa = sBrzozowski(dfa);
+	dfa = DeterministicFiniteAutomaton::brzozowski(dfa, [](const std::string& name, const FiniteAutomaton& automaton) {
+		std::cout << name << ":\n" << generateLinkToGraphvizOnline(automaton.toDotFormat()) << std::endl;
+	});
+	const auto matcher = dfa.compile();
 
 	std::cout << "Input string (or \"exit\")" << std::endl;
 	while (true) {
@@ -109,6 +96,6 @@ int main() {
 			break;
 		}
 
-		std::cout << dfa.accept(s) << std::endl;
+		std::cout << matcher.accept(s) << std::endl;
 	}
 }
@@ -1,192 +1,247 @@
 #include <parser/abstract_syntax_tree.hpp>
 
-#include <iomanip>
 #include <sstream>
 #include <stdexcept>
-
-#include <utils/set_utils.hpp>
+#include <string>
+#include <utility>
+#include <vector>
 
 
 namespace {
 
-using CallbackRef = const AbstractSyntaxTreeNode::Callback&;
-
-void sDummyCallback(AbstractSyntaxTreeNode*) {}
+// Preorder, left child first
+template <typename Callback>
+void sPreorder(const AbstractSyntaxTreeArena& arena, NodeId root, Callback&& callback) {
+	std::vector<NodeId> stack = {root};
+	while (!stack.empty()) {
+		const auto id = stack.back();
+		stack.pop_back();
 
-void sTraverse(AbstractSyntaxTreeNode* node,
-               CallbackRef onLeaf = sDummyCallback,
-               CallbackRef onOr = sDummyCallback,
-               CallbackRef onCat = sDummyCallback,
-               CallbackRef onStar = sDummyCallback) {
-
-	if (node->isLeaf()) {
-		onLeaf(node);
-		return;
-	}
-
-	node->applyToChildren([&](auto* child) { sTraverse(child, onLeaf, onOr, onCat, onStar); });
+		if (!callback(id)) {
+			return;
+		}
 
-	if (node->data == '|') {
-		onOr(node);
-	} else if (node->data == '&') {
-		onCat(node);
-	} else if (node->data == '*') {
-		onStar(node);
-	} else {
-		throw std::invalid_argument("[<anonymous namespace>::sTraverse] Unexpected AbstractSyntaxTreeNode");
+		for (auto child : {arena[id].right, arena[id].left}) {
+			if (child != kNoNode) {
+				stack.push_back(child);
+			}
+		}
 	}
 }
 
-AbstractSyntaxTreeNode* sFindLeaf(AbstractSyntaxTreeNode* node, char data) {
-	if (node->isLeaf()) {
-		return node->data == data ? node : nullptr;
-	}
-
-	for (auto child : {node->left, node->right}) {
-		if (child) {
-			if (auto accept_node = sFindLeaf(child, data); accept_node) {
-				return accept_node;
+// Calls onLeaf for the leaves of a rope from left to right; the walk is
+// linear in their number, as every joint has two non-empty sides
+template <typename Ropes, typename Callback>
+void sWalk(const Ropes& ropes, uint32_t rope, Callback&& onLeaf) {
+	std::vector<uint32_t> stack;
+	while (true) {
+		const auto& [left, right] = ropes[rope];
+		if (ropes[rope].isLeaf()) {
+			onLeaf(left);
+			if (stack.empty()) {
+				return;
 			}
+			rope = stack.back();
+			stack.pop_back();
+		} else {
+			stack.push_back(right);
+			rope = left;
 		}
 	}
+}
 
-	return nullptr;
+std::string sByteLabel(size_t b) {
+	if (b < 0x20 || b >= 0x7f || b == '"' || b == '\\') {
+		static constexpr char kHex[] = "0123456789abcdef";
+		return std::string{"0x"} + kHex[b / 16] + kHex[b % 16];
+	}
+	return std::string(1, static_cast<char>(b));
 }
 
-std::string sConvertToDotFormatInternal(AbstractSyntaxTreeNode* root) {
-	if (!root) {
-		return "";
+// Class leaves are shown as their ranges, e.g. [0-9a-f]
+std::string sLabel(const AbstractSyntaxTreeArena& arena, NodeId id) {
+	switch (arena[id].data.kind) {
+		case NodeKind::Empty: return "ε";
+		case NodeKind::Byte: return sByteLabel(static_cast<unsigned char>(arena[id].data.byte));
+		case NodeKind::Class: break;
+		case NodeKind::EndMarker: return "#";
+		case NodeKind::Or: return "|";
+		case NodeKind::Cat: return "&";
+		case NodeKind::Star: return "*";
+		case NodeKind::Plus: return "+";
+		case NodeKind::Optional: return "?";
 	}
 
-	std::stringstream stream;
-	stream << "\t\"" << std::hex << reinterpret_cast<void*>(root) << "\" [label=\"" << root->data << "\"]\n";
-	if (root->left || root->right) {
-		stream << "\t\"" << std::hex << reinterpret_cast<void*>(root) << "\" -- {\n";
-		for (auto* child : {root->left, root->right}) {
-			if (child) {
-				stream << "\t\t\"" << std::hex << reinterpret_cast<void*>(child) << "\"\n";
-			}
+	const auto bytes = arena.bytes(id);
+	std::string result = "[";
+	for (size_t b = 0; b < 256; ++b) {
+		if (!bytes[b]) {
+			continue;
 		}
-		stream << "\t}\n\n";
-	}
 
-	stream << sConvertToDotFormatInternal(root->left);
-	stream << sConvertToDotFormatInternal(root->right);
+		auto last = b;
+		while (last + 1 < 256 && bytes[last + 1]) {
+			++last;
+		}
 
-	return stream.str();
+		result += sByteLabel(b);
+		if (last != b) {
+			result += (last == b + 1 ? "" : "-") + sByteLabel(last);
+		}
+		b = last;
+	}
+	return result + "]";
 }
 
 }  // namespace
 
 
-AbstractSyntaxTree::AbstractSyntaxTree(AbstractSyntaxTreeNode* root)
-	: root_{root}
+AbstractSyntaxTree::AbstractSyntaxTree(AbstractSyntaxTreeArena arena, NodeId root)
+	: arena_{std::move(arena)}
+	, root_{root}
 {
-	if (!root_) {
-		throw std::invalid_argument("[AbstractSyntaxTree::AbstractSyntaxTree] root is nullptr");
+	if (root_ >= arena_.size()) {
+		throw std::invalid_argument("[AbstractSyntaxTree::AbstractSyntaxTree] root is not in arena");
 	}
 
-	numerateLeaves_();
+	analyze_();
+}
+
+// Single post-order pass, children are analyzed before their parent
+void AbstractSyntaxTree::analyze_() {
+	const auto size = arena_.size();
+	leaf_to_index_.assign(size, 0);
+	index_to_leaf_.assign(1, kNoNode);
+	nullable_.assign(size, false);
+	follow_pos_.assign(size, {});
+	first_pos_.assign(size, kNoRope_);
+	last_pos_.assign(size, kNoRope_);
+	ropes_.clear();
+
+	std::vector<std::pair<NodeId, bool>> stack = {{root_, false}};
+	while (!stack.empty()) {
+		auto [id, expanded] = stack.back();
+		stack.pop_back();
+
+		const auto& node = arena_[id];
+		if (expanded || node.isLeaf()) {
+			analyzeNode_(id);
+			continue;
+		}
 
-	calculateNullable_();
-	calculateFirstPos_();
-	calculateLastPos_();
-	calculateFollowPos_();
+		stack.emplace_back(id, true);
+		for (auto child : {node.right, node.left}) {
+			if (child != kNoNode) {
+				stack.emplace_back(child, false);
+			}
+		}
+	}
 }
 
-AbstractSyntaxTree::~AbstractSyntaxTree() {
-	AbstractSyntaxTreeNode::clear(root_);
+// firstpos and lastpos take O(1) per node, followpos costs the size of
+// the sets it links
+void AbstractSyntaxTree::analyzeNode_(NodeId id) {
+	const auto& node = arena_[id];
+
+	if (node.isLeaf()) {
+		leaf_to_index_[id] = index_to_leaf_.size();
+		index_to_leaf_.push_back(id);
+		nullable_[id] = node.data.kind == NodeKind::Empty;
+		if (!nullable_[id]) {
+			first_pos_[id] = last_pos_[id] = leafRope_(id);
+		}
+	} else if (node.data.kind == NodeKind::Or) {
+		nullable_[id] = nullable_[node.left] || nullable_[node.right];
+		first_pos_[id] = join_(first_pos_[node.left], first_pos_[node.right]);
+		last_pos_[id] = join_(last_pos_[node.left], last_pos_[node.right]);
+	} else if (node.data.kind == NodeKind::Cat) {
+		nullable_[id] = nullable_[node.left] && nullable_[node.right];
+		first_pos_[id] = nullable_[node.left] ? join_(first_pos_[node.left], first_pos_[node.right]) : first_pos_[node.left];
+		last_pos_[id] = nullable_[node.right] ? join_(last_pos_[node.left], last_pos_[node.right]) : last_pos_[node.right];
+
+		link_(last_pos_[node.left], first_pos_[node.right]);
+	} else if (node.data.kind == NodeKind::Star || node.data.kind == NodeKind::Plus || node.data.kind == NodeKind::Optional) {
+		nullable_[id] = node.data.kind != NodeKind::Plus || nullable_[node.left];
+		first_pos_[id] = first_pos_[node.left];
+		last_pos_[id] = last_pos_[node.left];
+
+		if (node.data.kind != NodeKind::Optional) {
+			link_(last_pos_[id], first_pos_[id]);
+		}
+	} else {
+		throw std::invalid_argument("[AbstractSyntaxTree::analyzeNode_] Unexpected AbstractSyntaxTreeNode");
+	}
 }
 
-void AbstractSyntaxTree::numerateLeaves_() {
-	size_t i = 1;
+uint32_t AbstractSyntaxTree::leafRope_(NodeId leaf) {
+	ropes_.push_back({leaf, kNoRope_});
+	return static_cast<uint32_t>(ropes_.size() - 1);
+}
 
-	sTraverse(
-		root_,
-		[&](auto* node) {
-			leaf_to_index_[node] = i;
-			index_to_leaf_[i] = node;
-			++i;
-		}
-	);
+// Joining an empty rope shares the other one, so every joint has two non-empty sides
+uint32_t AbstractSyntaxTree::join_(uint32_t left, uint32_t right) {
+	if (left == kNoRope_ || right == kNoRope_) {
+		return left == kNoRope_ ? right : left;
+	}
+	ropes_.push_back({left, right});
+	return static_cast<uint32_t>(ropes_.size() - 1);
 }
 
-void AbstractSyntaxTree::calculateNullable_() {
-	sTraverse(
-		root_,
-		[&](auto* node) { nullable_[node] = node->data == 'E'; },
-		[&](auto* node) { nullable_[node] = nullable_[node->left] || nullable_[node->right]; },
-		[&](auto* node) { nullable_[node] = nullable_[node->left] && nullable_[node->right]; },
-		[&](auto* node) { nullable_[node] = true; }
-	);
+void AbstractSyntaxTree::link_(uint32_t from, uint32_t to) {
+	if (from == kNoRope_ || to == kNoRope_) {
+		return;
+	}
+
+	const auto first = collect_(to);
+	sWalk(ropes_, from, [&](auto leaf) { follow_pos_[leaf] |= first; });
 }
 
-void AbstractSyntaxTree::calculateFirstPos_() {
-	sTraverse(
-		root_,
-		[&](auto* node) {
-			if (node->data == 'E') {
-				first_pos_[node] = {};
-			} else {
-				first_pos_[node] = {leaf_to_index_[node]};
-			}
-		},
-		[&](auto* node) { first_pos_[node] = SetUtils::Union(first_pos_[node->left], first_pos_[node->right]); },
-		[&](auto* node) {
-			if (nullable_[node->left]) {
-				first_pos_[node] = SetUtils::Union(first_pos_[node->left], first_pos_[node->right]);
-			} else {
-				first_pos_[node] = first_pos_[node->left];
-			}
-		},
-		[&](auto* node) { first_pos_[node] = first_pos_[node->left]; }
-	);
+// Left sides are visited first, so positions arrive in increasing order
+PositionSet AbstractSyntaxTree::collect_(uint32_t rope) const {
+	PositionSet result;
+	if (rope == kNoRope_) {
+		return result;
+	}
+	sWalk(ropes_, rope, [&](auto leaf) { result.insert(leaf_to_index_[leaf]); });
+	return result;
 }
 
-void AbstractSyntaxTree::calculateLastPos_() {
-	sTraverse(
-		root_,
-		[&](auto* node) {
-			if (node->data == 'E') {
-				last_pos_[node] = {};
-			} else {
-				last_pos_[node] = {leaf_to_index_[node]};
-			}
-		},
-		[&](auto* node) { last_pos_[node] = SetUtils::Union(last_pos_[node->left], last_pos_[node->right]); },
-		[&](auto* node) {
-			if (nullable_[node->right]) {
-				last_pos_[node] = SetUtils::Union(last_pos_[node->left], last_pos_[node->right]);
-			} else {
-				last_pos_[node] = last_pos_[node->right];
-			}
-		},
-		[&](auto* node) { last_pos_[node] = last_pos_[node->left]; }
-	);
+PositionSet AbstractSyntaxTree::firstPos(NodeId id) const {
+	return collect_(first_pos_[id]);
 }
 
-void AbstractSyntaxTree::calculateFollowPos_() {
-	sTraverse(
-		root_,
-		sDummyCallback,
-		sDummyCallback,
-		[&](auto* node) {
-			for (auto i : last_pos_[node->left]) {
-				SetUtils::append(follow_pos_[index_to_leaf_[i]], first_pos_[node->right]);
-			}
-		},
-		[&](auto* node) {
-			for (auto i : last_pos_[node]) {
-				SetUtils::append(follow_pos_[index_to_leaf_[i]], first_pos_[node]);
-			}
-		}
-	);
+PositionSet AbstractSyntaxTree::lastPos(NodeId id) const {
+	return collect_(last_pos_[id]);
 }
 
-AbstractSyntaxTreeNode* AbstractSyntaxTree::findLeaf(char data) {
-	return sFindLeaf(root_, data);
+NodeId AbstractSyntaxTree::findLeaf(NodeKind kind) const {
+	auto result = kNoNode;
+	sPreorder(arena_, root_, [&](auto id) {
+		if (arena_[id].isLeaf() && arena_[id].data.kind == kind) {
+			result = id;
+		}
+		return result == kNoNode;
+	});
+	return result;
 }
 
 std::string AbstractSyntaxTree::toDotFormat() const {
-	return "graph AST {\n" + sConvertToDotFormatInternal(root_) + "}\n";
+	std::stringstream stream;
+	stream << "graph AST {\n";
+	sPreorder(arena_, root_, [&](auto id) {
+		const auto& node = arena_[id];
+		stream << "\t\"" << id << "\" [label=\"" << sLabel(arena_, id) << "\"]\n";
+		if (!node.isLeaf()) {
+			stream << "\t\"" << id << "\" -- {\n";
+			for (auto child : {node.left, node.right}) {
+				if (child != kNoNode) {
+					stream << "\t\t\"" << child << "\"\n";
+				}
+			}
+			stream << "\t}\n\n";
+		}
+		return true;
+	});
+	stream << "}\n";
+	return stream.str();
 }
@@ -1,41 +1,74 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
 
 #include <types/abstract_syntax_tree_node.hpp>
-#include <types/common.hpp>
+#include <types/position_set.hpp>
 
 
 class AbstractSyntaxTree {
 public:
-	explicit AbstractSyntaxTree(AbstractSyntaxTreeNode* root);
-	~AbstractSyntaxTree();
+	// Takes ownership of the arena, root must be one of its nodes
+	AbstractSyntaxTree(AbstractSyntaxTreeArena arena, NodeId root);
 
-	auto& root() { return root_; }
-	auto& leafToIndex() { return leaf_to_index_; };
-	auto& indexToLeaf() { return index_to_leaf_; };
-	auto& nullable() { return nullable_; }
-	auto& firstPos() { return first_pos_; }
-	auto& lastPos() { return last_pos_; }
-	auto& followPos() { return follow_pos_; }
+	NodeId root() const { return root_; }
+	const AbstractSyntaxTreeNode& node(NodeId id) const { return arena_[id]; }
+	ByteSet bytes(NodeId leaf) const { return arena_.bytes(leaf); }
 
-	AbstractSyntaxTreeNode* findLeaf(char data);
+	// Indexed by node id, positions start from 1 (0 for inner nodes)
+	const auto& leafToIndex() const { return leaf_to_index_; }
+	// Indexed by position, slot 0 is kNoNode
+	const auto& indexToLeaf() const { return index_to_leaf_; }
+
+	// Indexed by node id, followPos is empty for inner nodes
+	const auto& nullable() const { return nullable_; }
+	const auto& followPos() const { return follow_pos_; }
+
+	// Kept as ropes joining the sets of the children, so storage stays linear
+	// in the size of the tree and collecting is linear in the result.
+	// Empty for nodes outside the tree of root
+	PositionSet firstPos(NodeId id) const;
+	PositionSet lastPos(NodeId id) const;
+
+	// First leaf of kind in preorder, kNoNode if there is no such leaf
+	NodeId findLeaf(NodeKind kind) const;
 
 	std::string toDotFormat() const;
 
 private:
-	AbstractSyntaxTreeNode* root_;
-
-	UMap<AbstractSyntaxTreeNode*, size_t> leaf_to_index_;  // TODO: delete indices and use pointers
-	UMap<size_t, AbstractSyntaxTreeNode*> index_to_leaf_;
-	UMap<AbstractSyntaxTreeNode*, bool> nullable_;
-	UMap<AbstractSyntaxTreeNode*, Set<size_t>> first_pos_;
-	UMap<AbstractSyntaxTreeNode*, Set<size_t>> last_pos_;
-	UMap<AbstractSyntaxTreeNode*, Set<size_t>> follow_pos_;
-
-	void numerateLeaves_();
-	void calculateNullable_();
-	void calculateFirstPos_();
-	void calculateLastPos_();
-	void calculateFollowPos_();
+	AbstractSyntaxTreeArena arena_;
+	NodeId root_;
+
+	std::vector<size_t> leaf_to_index_;
+	std::vector<NodeId> index_to_leaf_;
+	std::vector<bool> nullable_;
+	std::vector<PositionSet> follow_pos_;
+
+	// A rope is a leaf (leaf, kNoRope_) or a joint (left rope, right rope),
+	// firstpos and lastpos of every node are one rope
+	static constexpr uint32_t kNoRope_ = UINT32_MAX;
+
+	struct Rope_ {
+		uint32_t left;
+		uint32_t right;
+
+		bool isLeaf() const { return right == kNoRope_; }
+	};
+
+	std::vector<Rope_> ropes_;
+	std::vector<uint32_t> first_pos_;
+	std::vector<uint32_t> last_pos_;
+
+	void analyze_();
+	void analyzeNode_(NodeId id);
+
+	uint32_t leafRope_(NodeId leaf);
+	uint32_t join_(uint32_t left, uint32_t right);
+
+	// followpos of every leaf of from gets the positions of to
+	void link_(uint32_t from, uint32_t to);
+	PositionSet collect_(uint32_t rope) const;
 };
@@ -1,28 +1,49 @@
 #pragma once
 
+#include <cstddef>
+#include <stdexcept>
+#include <string>
 #include <string_view>
 
 
+// constexpr, so that StaticCompiler can read patterns at compile time
 class CharReader {
 protected:
 	// Sets new string
-	void load_(std::string_view string);
+	constexpr void load_(std::string_view string) { remain_ = string; }
 
 	// Returns first character
-	char peek_() const;
+	constexpr char peek_() const { return remain_[0]; }
 
 	// Deletes first character
-	void eat_();
+	constexpr void eat_() { remain_.remove_prefix(1); }
 
 	// Deletes first character with check
 	// Throws std::invalid_argument if first character and c are different
-	void eat_(char c);
+	constexpr void eat_(char c) {
+		if (peek_() != c) {
+			using namespace std::string_literals;
+			throw std::invalid_argument("[CharReader::eat_] Expected '"s + c + "', got '" + peek_() + "'.");
+		}
+
+		eat_();
+	}
 
 	// Deletes and returns first character
-	char next_();
+	constexpr char next_() {
+		const auto c = peek_();
+		eat_();
+		return c;
+	}
 
 	// Returns true if there are no characters left
-	bool empty_();
+	constexpr bool empty_() const { return remain_.empty(); }
+
+	// Returns the characters left
+	constexpr std::string_view rest_() const { return remain_; }
+
+	// Deletes count first characters
+	constexpr void skip_(size_t count) { remain_.remove_prefix(count); }
 
 private:
 	std::string_view remain_;
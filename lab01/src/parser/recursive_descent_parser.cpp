@@ -1,56 +1,53 @@
 #include <parser/recursive_descent_parser.hpp>
 
+#include <parser/regex_grammar.hpp>
 
-AbstractSyntaxTreeNode* RecursiveDescentParser::parse(std::string_view expression) {
-	load_(expression);
-	return regex_();
-}
 
-AbstractSyntaxTreeNode* RecursiveDescentParser::regex_() {
-	auto* term = term_();
+namespace {
 
-	if (!empty_() && peek_() == '|') {
-		eat_();  // '|'
-		auto* regex = regex_();
-		return new AbstractSyntaxTreeNode{'|', term, regex};
-	}
+// RegexGrammar builder of arena nodes. A single-byte set is a Byte leaf, any
+// other a Class leaf
+class ArenaBuilder {
+public:
+	using Node = NodeId;
 
-	return term;
-}
-
-AbstractSyntaxTreeNode* RecursiveDescentParser::term_() {
-	if (empty_() || peek_() == ')' || peek_() == '|') {
-		return new AbstractSyntaxTreeNode{'E'};
+	explicit ArenaBuilder(AbstractSyntaxTreeArena& arena)
+		: arena_{&arena}
+	{
 	}
 
-	auto* factor = factor_();
+	NodeId empty() { return arena_->create({NodeKind::Empty}); }
+
+	NodeId leaf(const ByteMask& bytes) {
+		if (const auto byte = bytes.single(); byte >= 0) {
+			return arena_->create({NodeKind::Byte, static_cast<char>(byte)});
+		}
 
-	while (!empty_() && peek_() != ')' && peek_() != '|') {
-		auto* next_factor = factor_();
-		factor = new AbstractSyntaxTreeNode{'&', factor, next_factor};
+		ByteSet set;
+		for (size_t b = 0; b < 256; ++b) {
+			set[b] = bytes.test(b);
+		}
+		return arena_->createClass(set);
 	}
 
-	return factor;
-}
+	NodeId cat(NodeId left, NodeId right) { return arena_->create({NodeKind::Cat}, left, right); }
+	NodeId alternative(NodeId left, NodeId right) { return arena_->create({NodeKind::Or}, left, right); }
 
-AbstractSyntaxTreeNode* RecursiveDescentParser::factor_() {
-	auto* base = base_();
+	NodeId star(NodeId node) { return arena_->create({NodeKind::Star}, node); }
+	NodeId plus(NodeId node) { return arena_->create({NodeKind::Plus}, node); }
+	NodeId optional(NodeId node) { return arena_->create({NodeKind::Optional}, node); }
 
-	while (!empty_() && peek_() == '*') {
-		eat_();  // '*';
-		base = new AbstractSyntaxTreeNode{'*', base};
-	}
+	NodeId clone(NodeId node) { return arena_->clone(node); }
+	size_t size(NodeId node) const { return arena_->size(node); }
 
-	return base;
-}
+private:
+	AbstractSyntaxTreeArena* arena_;
+};
+
+}  // namespace
 
-AbstractSyntaxTreeNode* RecursiveDescentParser::base_() {
-	if (peek_() == '(') {
-		eat_();  // '('
-		auto* regex = regex_();
-		eat_(')');
-		return regex;
-	}
 
-	return new AbstractSyntaxTreeNode{next_()};
+NodeId RecursiveDescentParser::parse(std::string_view expression, AbstractSyntaxTreeArena& arena) {
+	ArenaBuilder builder{arena};
+	return RegexGrammar<ArenaBuilder>{builder}.parse(expression);
 }
@@ -1,17 +1,15 @@
 #pragma once
 
-#include <parser/char_reader.hpp>
+#include <string_view>
+
 #include <types/abstract_syntax_tree_node.hpp>
 
 
-class RecursiveDescentParser : public CharReader
+// Syntax tree of an expression in the syntax of RegexGrammar
+class RecursiveDescentParser
 {
 public:
-	AbstractSyntaxTreeNode* parse(std::string_view expression);
-
-private:
-	AbstractSyntaxTreeNode* regex_();
-	AbstractSyntaxTreeNode* term_();
-	AbstractSyntaxTreeNode* factor_();
-	AbstractSyntaxTreeNode* base_();
+	// Nodes are allocated in arena, returns the root
+	// Throws std::invalid_argument on malformed expressions
+	NodeId parse(std::string_view expression, AbstractSyntaxTreeArena& arena);
 };
@@ -0,0 +1,599 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <parser/char_reader.hpp>
+#include <utils/utf8_utils.hpp>
+
+
+// Set of byte values, unlike std::bitset usable in constant evaluation
+class ByteMask {
+public:
+	static constexpr ByteMask range(size_t first, size_t last) {
+		ByteMask result;
+		for (auto b = first; b <= last; ++b) {
+			result.set(b);
+		}
+		return result;
+	}
+
+	static constexpr ByteMask byte(char c) {
+		ByteMask result;
+		result.set(static_cast<unsigned char>(c));
+		return result;
+	}
+
+	constexpr void set(size_t b) { words_[b / 64] |= uint64_t{1} << (b % 64); }
+	constexpr bool test(size_t b) const { return (words_[b / 64] >> (b % 64)) & 1; }
+
+	constexpr bool any() const { return *this != ByteMask{}; }
+
+	// Bytes 80-FF: all of them are in the set / some of them are
+	constexpr bool allHigh() const { return words_[2] == ~uint64_t{0} && words_[3] == ~uint64_t{0}; }
+	constexpr bool anyHigh() const { return words_[2] != 0 || words_[3] != 0; }
+
+	// The byte of a single-byte set or -1
+	constexpr int single() const {
+		auto result = -1;
+		for (size_t i = 0; i < words_.size(); ++i) {
+			if (words_[i] == 0) {
+				continue;
+			}
+			if (result >= 0 || !std::has_single_bit(words_[i])) {
+				return -1;
+			}
+			result = static_cast<int>(64 * i) + std::countr_zero(words_[i]);
+		}
+		return result;
+	}
+
+	constexpr ByteMask operator|(const ByteMask& other) const {
+		auto result = *this;
+		for (size_t i = 0; i < words_.size(); ++i) {
+			result.words_[i] |= other.words_[i];
+		}
+		return result;
+	}
+
+	constexpr ByteMask operator~() const {
+		auto result = *this;
+		for (auto& word : result.words_) {
+			word = ~word;
+		}
+		return result;
+	}
+
+	constexpr bool operator==(const ByteMask&) const = default;
+
+private:
+	std::array<uint64_t, 4> words_ = {};
+};
+
+
+// Grammar of the recursive descent formulation
+//   regex  := term ('|' regex)?
+//   term   := factor* (empty term is an Empty leaf)
+//   factor := base ('*' | '+' | '?' | '{' m [',' [n]] '}')*
+//   base   := '(' regex ')' | '[' ['^'] items ']' | '\' escape | char
+// driven by an explicit stack of open groups, so nesting depth and
+// pattern length are limited by memory only.
+//
+// Every byte value is a literal, UTF-8 characters and \u{H...} are single
+// factors. A class is a single byte-set leaf unless it mentions a non-ASCII
+// codepoint; then it matches codepoints and becomes an alternation of UTF-8
+// byte range sequences. Escapes \d \w \s (and negations) are classes, \xHH
+// is a raw byte. Counted repetition copies its operand, so counts are
+// limited to kMaxRepeat and all copies of an expression together to
+// kMaxRepeatSize nodes.
+//
+// Builder makes the nodes, so that RecursiveDescentParser builds a syntax
+// tree at run time and StaticCompiler Glushkov fragments at compile time
+// from the same grammar. It has a default-constructible Node type and
+//   Node empty(), leaf(const ByteMask&), cat(Node, Node), alternative(Node, Node),
+//        star(Node), plus(Node), optional(Node), clone(const Node&)
+//   size_t size(const Node&)
+// where a clone copies everything made for a factor, but not what the factor
+// was joined to afterwards, and size counts what a clone would make.
+template <typename Builder>
+class RegexGrammar : public CharReader
+{
+public:
+	using Node = typename Builder::Node;
+
+	static constexpr size_t kMaxRepeat = 1000;
+	static constexpr size_t kMaxRepeatSize = size_t{1} << 22;
+
+	constexpr explicit RegexGrammar(Builder& builder)
+		: builder_{&builder}
+	{
+	}
+
+	// Throws std::invalid_argument on malformed expressions
+	constexpr Node parse(std::string_view expression) {
+		load_(expression);
+		groups_.assign(1, {});
+		repeated_ = 0;
+
+		while (!empty_()) {
+			const auto c = peek_();
+			const auto is_postfix = (c == '*' || c == '+' || c == '?' || c == '{') && groups_.back().has_factor;
+
+			if (c != '(' && c != ')' && c != '|' && c != '[' && !is_postfix) {
+				// Postfix operators without a preceding factor are literals
+				pushFactor_(atom_(item_()));
+				continue;
+			}
+
+			eat_();
+			auto& factor = groups_.back().factor;
+			if (c == '(') {
+				groups_.emplace_back();
+			} else if (c == ')') {
+				if (groups_.size() == 1) {
+					throw std::invalid_argument("[RegexGrammar::parse] Unexpected ')'");
+				}
+				pushFactor_(closeGroup_());
+			} else if (c == '|') {
+				closeTerm_();
+			} else if (c == '*') {
+				factor = builder_->star(std::move(factor));
+			} else if (c == '+') {
+				factor = builder_->plus(std::move(factor));
+			} else if (c == '?') {
+				factor = builder_->optional(std::move(factor));
+			} else if (c == '{') {
+				factor = repeat_(std::move(factor));
+			} else if (c == '[') {
+				pushFactor_(class_());
+			}
+		}
+
+		if (groups_.size() != 1) {
+			throw std::invalid_argument("[RegexGrammar::parse] Expected ')'");
+		}
+
+		return closeGroup_();
+	}
+
+private:
+	// One open parenthesis
+	struct Group_ {
+		std::vector<Node> alternatives;
+		Node term = {};    // concatenation of the finished factors
+		Node factor = {};  // last factor, postfix operators still apply to it
+		bool has_term = false;
+		bool has_factor = false;
+	};
+
+	// A byte set or a single codepoint
+	struct Item_ {
+		ByteMask bytes = {};
+		char32_t codepoint = 0;
+		bool is_codepoint = false;
+	};
+
+	struct CodepointRange_ {
+		char32_t first;
+		char32_t last;
+
+		constexpr bool operator<(const CodepointRange_& other) const {
+			return first < other.first || (first == other.first && last < other.last);
+		}
+	};
+
+	Builder* builder_;
+	std::vector<Group_> groups_;
+	size_t repeated_ = 0;  // nodes made by the clones so far, clones of clones included
+
+	// Written with if rather than ?: mixing an lvalue and a temporary, which GCC 12
+	// miscompiles in constant evaluation (double deallocation)
+	constexpr Node cat_(bool has_left, Node left, Node right) {
+		if (has_left) {
+			return builder_->cat(std::move(left), std::move(right));
+		}
+		return right;
+	}
+
+	// Alternation is right-associative
+	constexpr Node alternatives_(std::vector<Node>& alternatives) {
+		auto regex = std::move(alternatives.back());
+		for (auto i = alternatives.size() - 1; i-- > 0;) {
+			regex = builder_->alternative(std::move(alternatives[i]), std::move(regex));
+		}
+		return regex;
+	}
+
+	// Concatenation is left-associative
+	constexpr void pushFactor_(Node factor) {
+		finishFactor_();
+
+		auto& group = groups_.back();
+		group.factor = std::move(factor);
+		group.has_factor = true;
+	}
+
+	constexpr void finishFactor_() {
+		auto& group = groups_.back();
+		if (group.has_factor) {
+			group.term = cat_(group.has_term, std::move(group.term), std::move(group.factor));
+			group.has_term = true;
+			group.has_factor = false;
+		}
+	}
+
+	constexpr void closeTerm_() {
+		finishFactor_();
+
+		auto& group = groups_.back();
+		if (group.has_term) {
+			group.alternatives.push_back(std::move(group.term));
+		} else {
+			group.alternatives.push_back(builder_->empty());
+		}
+		group.has_term = false;
+	}
+
+	// The group is popped
+	constexpr Node closeGroup_() {
+		closeTerm_();
+
+		auto alternatives = std::move(groups_.back().alternatives);
+		groups_.pop_back();
+		return alternatives_(alternatives);
+	}
+
+	// Next literal byte, escape or well-formed UTF-8 character
+	constexpr Item_ item_() {
+		char32_t codepoint = 0;
+		if (const auto size = Utf8Utils::decode(rest_(), codepoint); size > 1) {
+			skip_(size);
+			return {{}, codepoint, true};
+		}
+
+		const auto c = next_();
+		if (c != '\\') {
+			return {ByteMask::byte(c)};
+		}
+
+		if (!empty_() && peek_() == 'u') {
+			eat_();  // 'u'
+			return {{}, unicodeEscape_(), true};
+		}
+
+		return {escape_()};
+	}
+
+	// A codepoint outside a class is the concatenation of its UTF-8 bytes
+	constexpr Node atom_(const Item_& item) {
+		if (!item.is_codepoint) {
+			return builder_->leaf(item.bytes);
+		}
+
+		Node result = {};
+		auto first = true;
+		for (auto c : Utf8Utils::encode(item.codepoint)) {
+			result = cat_(!first, std::move(result), builder_->leaf(ByteMask::byte(c)));
+			first = false;
+		}
+		return result;
+	}
+
+	// After '[': items are bytes, escapes, UTF-8 characters and ranges a-z,
+	// ']' first and '-' last are literals
+	constexpr Node class_() {
+		const auto negate = !empty_() && peek_() == '^';
+		if (negate) {
+			eat_();  // '^'
+		}
+
+		ByteMask bytes;
+		std::vector<CodepointRange_> codepoints;
+		const auto add = [&](const Item_& item) {
+			if (item.is_codepoint) {
+				codepoints.push_back({item.codepoint, item.codepoint});
+			} else {
+				bytes = bytes | item.bytes;
+			}
+		};
+
+		for (auto first = true;; first = false) {
+			if (empty_()) {
+				throw std::invalid_argument("[RegexGrammar::class_] Expected ']'");
+			}
+			if (peek_() == ']' && !first) {
+				eat_();  // ']'
+				break;
+			}
+
+			const auto item = item_();
+			if ((!item.is_codepoint && item.bytes.single() < 0) || empty_() || peek_() != '-') {
+				add(item);
+				continue;
+			}
+
+			eat_();  // '-'
+			if (empty_() || peek_() == ']') {
+				add(item);
+				bytes.set('-');
+				continue;
+			}
+
+			const auto last = item_();
+			const auto value = [](const Item_& i) { return i.is_codepoint ? int64_t{i.codepoint} : int64_t{i.bytes.single()}; };
+			const auto is_byte_range = !item.is_codepoint && !last.is_codepoint;
+
+			// Byte ends of a codepoint range must be ASCII
+			const auto is_ascii_or_codepoint = [&](const Item_& i) { return i.is_codepoint || value(i) < 0x80; };
+			if (value(last) < value(item) || (!is_byte_range && !(is_ascii_or_codepoint(item) && is_ascii_or_codepoint(last)))) {
+				throw std::invalid_argument("[RegexGrammar::class_] Invalid range");
+			}
+
+			if (is_byte_range) {
+				bytes = bytes | ByteMask::range(static_cast<size_t>(value(item)), static_cast<size_t>(value(last)));
+			} else {
+				codepoints.push_back({static_cast<char32_t>(value(item)), static_cast<char32_t>(value(last))});
+			}
+		}
+
+		if (codepoints.empty()) {
+			return builder_->leaf(negate ? ~bytes : bytes);
+		}
+
+		return codepoints_(bytes, std::move(codepoints), negate);
+	}
+
+	// Bytes below 80 are ASCII codepoints, a set with all of 80-FF (from \D, \W, \S)
+	// stands for every non-ASCII codepoint
+	constexpr Node codepoints_(const ByteMask& bytes, std::vector<CodepointRange_> ranges, bool negate) {
+		if (bytes.allHigh()) {
+			ranges.push_back({0x80, Utf8Utils::kMaxCodepoint});
+		} else if (bytes.anyHigh()) {
+			throw std::invalid_argument("[RegexGrammar::class_] Raw bytes cannot be mixed with codepoints");
+		}
+
+		for (char32_t b = 0; b < 0x80; ++b) {
+			if (bytes.test(b)) {
+				ranges.push_back({b, b});
+			}
+		}
+
+		std::sort(ranges.begin(), ranges.end());
+		std::vector<CodepointRange_> merged;
+		for (auto&& range : ranges) {
+			if (!merged.empty() && range.first <= merged.back().last + 1) {
+				merged.back().last = std::max(merged.back().last, range.last);
+			} else {
+				merged.push_back(range);
+			}
+		}
+
+		if (negate) {
+			std::vector<CodepointRange_> complement;
+			char32_t next = 0;
+			for (auto&& range : merged) {
+				if (range.first > next) {
+					complement.push_back({next, range.first - 1});
+				}
+				next = range.last + 1;
+			}
+			if (next <= Utf8Utils::kMaxCodepoint) {
+				complement.push_back({next, Utf8Utils::kMaxCodepoint});
+			}
+			merged = std::move(complement);
+		}
+
+		// ASCII part is one leaf, the rest one byte-range chain per UTF-8 sequence
+		ByteMask ascii;
+		std::vector<Node> alternatives;
+		for (auto&& range : merged) {
+			for (auto c = range.first; c <= range.last && c < 0x80; ++c) {
+				ascii.set(c);
+			}
+
+			if (range.last < 0x80) {
+				continue;
+			}
+
+			for (auto&& sequence : Utf8Utils::sequences(std::max(range.first, char32_t{0x80}), range.last)) {
+				Node chain = {};
+				auto first = true;
+				for (auto&& [from, to] : sequence) {
+					chain = cat_(!first, std::move(chain), builder_->leaf(ByteMask::range(from, to)));
+					first = false;
+				}
+				alternatives.push_back(std::move(chain));
+			}
+		}
+
+		if (ascii.any() || alternatives.empty()) {
+			alternatives.insert(alternatives.begin(), builder_->leaf(ascii));
+		}
+
+		return alternatives_(alternatives);
+	}
+
+	// After '\': \d \w \s and their negations \D \W \S, \n \t \r \f \v \0,
+	// \xHH, any other byte stands for itself
+	constexpr ByteMask escape_() {
+		if (empty_()) {
+			throw std::invalid_argument("[RegexGrammar::escape_] Trailing '\\'");
+		}
+
+		const auto digits = ByteMask::range('0', '9');
+		const auto word = ByteMask::range('a', 'z') | ByteMask::range('A', 'Z') | digits | ByteMask::byte('_');
+		const auto space = ByteMask::range('\t', '\r') | ByteMask::byte(' ');
+
+		const auto c = next_();
+		switch (c) {
+			case 'd': return digits;
+			case 'D': return ~digits;
+			case 'w': return word;
+			case 'W': return ~word;
+			case 's': return space;
+			case 'S': return ~space;
+			case 'n': return ByteMask::byte('\n');
+			case 't': return ByteMask::byte('\t');
+			case 'r': return ByteMask::byte('\r');
+			case 'f': return ByteMask::byte('\f');
+			case 'v': return ByteMask::byte('\v');
+			case '0': return ByteMask::byte('\0');
+			case 'x': {
+				const auto high = empty_() ? -1 : hexDigit_(next_());
+				const auto low = empty_() ? -1 : hexDigit_(next_());
+				if (high < 0 || low < 0) {
+					throw std::invalid_argument("[RegexGrammar::escape_] Expected two hex digits after \\x");
+				}
+				const auto byte = static_cast<size_t>(high * 16 + low);
+				return ByteMask::range(byte, byte);
+			}
+			default: return ByteMask::byte(c);
+		}
+	}
+
+	static constexpr int hexDigit_(char c) {
+		if (c >= '0' && c <= '9') {
+			return c - '0';
+		}
+		if (c >= 'a' && c <= 'f') {
+			return c - 'a' + 10;
+		}
+		if (c >= 'A' && c <= 'F') {
+			return c - 'A' + 10;
+		}
+		return -1;
+	}
+
+	// After "\u": \u{H...} with up to six digits or \uHHHH
+	constexpr char32_t unicodeEscape_() {
+		const auto braced = !empty_() && peek_() == '{';
+		if (braced) {
+			eat_();  // '{'
+		}
+
+		char32_t result = 0;
+		size_t digits = 0;
+		while (!empty_() && (braced ? peek_() != '}' : digits < 4)) {
+			const auto digit = hexDigit_(next_());
+			if (digit < 0 || ++digits > 6) {
+				throw std::invalid_argument("[RegexGrammar::unicodeEscape_] Invalid codepoint");
+			}
+			result = result * 16 + static_cast<char32_t>(digit);
+		}
+
+		if (braced) {
+			if (empty_()) {
+				throw std::invalid_argument("[RegexGrammar::unicodeEscape_] Expected '}'");
+			}
+			eat_('}');
+		}
+
+		if (digits == 0 || (!braced && digits != 4) || !Utf8Utils::isValid(result)) {
+			throw std::invalid_argument("[RegexGrammar::unicodeEscape_] Invalid codepoint");
+		}
+
+		return result;
+	}
+
+	// After '{': x{m} = m copies, x{m,} = m - 1 copies and x+, x{m,n} = x{m} (x (x ...)?)?
+	constexpr Node repeat_(Node factor) {
+		const auto min = number_();
+		auto max = min;
+		auto unbounded = false;
+		if (!empty_() && peek_() == ',') {
+			eat_();  // ','
+			if (!empty_() && peek_() == '}') {
+				unbounded = true;
+			} else {
+				max = number_();
+			}
+		}
+
+		if (empty_()) {
+			throw std::invalid_argument("[RegexGrammar::repeat_] Expected '}'");
+		}
+		eat_('}');
+
+		if (max < min) {
+			throw std::invalid_argument("[RegexGrammar::repeat_] Invalid repetition bounds");
+		}
+		if (!unbounded && max == 0) {
+			return builder_->empty();
+		}
+
+		// The operand itself is the last copy, all clones are taken before it is joined
+		std::vector<Node> copies;
+		const auto count = unbounded ? std::max(min, size_t{1}) : max;
+		const auto size = (count - 1) * builder_->size(factor);
+		if (size > kMaxRepeatSize - repeated_) {
+			throw std::invalid_argument("[RegexGrammar::repeat_] Repetition makes the expression larger than " + std::to_string(kMaxRepeatSize) + " nodes");
+		}
+		repeated_ += size;
+		for (size_t i = 1; i < count; ++i) {
+			copies.push_back(builder_->clone(factor));
+		}
+		copies.push_back(std::move(factor));
+
+		Node result = {};
+		auto has_result = false;
+		const auto append = [&](Node node) {
+			result = cat_(has_result, std::move(result), std::move(node));
+			has_result = true;
+		};
+
+		if (unbounded) {
+			for (size_t i = 1; i < min; ++i) {
+				append(std::move(copies[i - 1]));
+			}
+			if (min) {
+				append(builder_->plus(std::move(copies.back())));
+			} else {
+				append(builder_->star(std::move(copies.back())));
+			}
+			return result;
+		}
+
+		for (size_t i = 0; i < min; ++i) {
+			append(std::move(copies[i]));
+		}
+
+		// Built from the innermost copy out
+		Node tail = {};
+		for (auto i = max; i-- > min;) {
+			if (i + 1 < max) {
+				tail = builder_->optional(builder_->cat(std::move(copies[i]), std::move(tail)));
+			} else {
+				tail = builder_->optional(std::move(copies[i]));
+			}
+		}
+		if (max > min) {
+			append(std::move(tail));
+		}
+
+		return result;
+	}
+
+	constexpr size_t number_() {
+		if (empty_() || peek_() < '0' || peek_() > '9') {
+			throw std::invalid_argument("[RegexGrammar::number_] Expected a number");
+		}
+
+		size_t result = 0;
+		while (!empty_() && peek_() >= '0' && peek_() <= '9') {
+			result = result * 10 + static_cast<size_t>(next_() - '0');
+			if (result > kMaxRepeat) {
+				throw std::invalid_argument("[RegexGrammar::number_] Repetition count is larger than " + std::to_string(kMaxRepeat));
+			}
+		}
+
+		return result;
+	}
+};
@@ -0,0 +1,42 @@
+#include <random>
+#include <string>
+
+#include <automaton/bit_parallel_automaton.hpp>
+#include <tests/common.hpp>
+
+
+namespace {
+
+void sReference() {
+	std::mt19937 rng(42);
+	const auto words = Test::words("ab0", 6);
+	for (size_t i = 0; i < 100; ++i) {
+		const auto pattern = Test::randomPattern(rng, 4);
+		const auto matcher = Test::compile(pattern);
+		const BitParallelAutomaton<2> parallel{pattern};
+		for (auto&& s : words) {
+			Test::check(parallel.accept(s) == matcher.accept(s), pattern + " on \"" + s + "\"");
+		}
+	}
+}
+
+// Empty leaves take no bits: 60 byte positions fit one word next to 60 empty leaves
+void sEmptyLeaves() {
+	const auto pattern = Test::repeat("(|a)(b|)", 30);
+	const BitParallelAutomaton<1> parallel{pattern};
+	const auto matcher = Test::compile(pattern);
+	for (auto&& s : Test::words("abc", 4)) {
+		Test::check(parallel.accept(s) == matcher.accept(s), "(|a)(b|) repeated on \"" + s + "\"");
+	}
+
+	Test::throws([] { BitParallelAutomaton<1>{Test::repeat("a", 64)}; }, "64 positions do not fit one word");
+}
+
+}  // namespace
+
+
+int main() {
+	sReference();
+	sEmptyLeaves();
+	return Test::finish();
+}
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+#include <random>
+#include <regex>
+#include <source_location>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <automaton/deterministic_finite_automaton.hpp>
+
+
+namespace Test {
+
+inline size_t failures = 0;
+
+inline void check(bool condition, std::string_view what, std::source_location location = std::source_location::current()) {
+	if (!condition) {
+		++failures;
+		std::fprintf(stderr, "%s:%u: failed: %.*s\n", location.file_name(), location.line(), static_cast<int>(what.size()), what.data());
+	}
+}
+
+// Checks that f throws std::invalid_argument
+template <typename F>
+void throws(F&& f, std::string_view what, std::source_location location = std::source_location::current()) {
+	auto thrown = false;
+	try {
+		f();
+	} catch (const std::invalid_argument&) {
+		thrown = true;
+	}
+	check(thrown, what, location);
+}
+
+// Exit code of a test executable
+inline int finish() {
+	if (failures != 0) {
+		std::fprintf(stderr, "%zu checks failed\n", failures);
+		return 1;
+	}
+	return 0;
+}
+
+inline CompiledAutomaton compile(const std::string& pattern) {
+	auto dfa = DeterministicFiniteAutomaton{pattern};
+	dfa.minimize();
+	return dfa.compile();
+}
+
+inline std::string repeat(const std::string& s, size_t n) {
+	std::string result;
+	for (size_t i = 0; i < n; ++i) {
+		result += s;
+	}
+	return result;
+}
+
+// Every string over letters of at most max_size characters, shortest first
+inline std::vector<std::string> words(std::string_view letters, size_t max_size) {
+	std::vector<std::string> result = {""};
+	for (size_t i = 0; i < result.size(); ++i) {
+		if (result[i].size() < max_size) {
+			for (auto c : letters) {
+				result.push_back(result[i] + c);
+			}
+		}
+	}
+	return result;
+}
+
+// Random pattern over a, b and 0 in the syntax shared with std::regex: groups,
+// alternation with empty alternatives, classes, \d, *, +, ? and counted repetition.
+// Loops never get a nullable operand, which would make std::regex backtrack for ages
+inline std::string randomPattern(std::mt19937& rng, size_t depth, bool* nullable = nullptr) {
+	bool ignored = false;
+	auto& is_nullable = nullable ? *nullable : ignored;
+
+	if (depth == 0 || rng() % 4 == 0) {
+		static const char* const kLeaves[] = {"a", "b", "0", "[ab]", "[^a]", "[a-b0]", "\\d", "()"};
+		const auto leaf = rng() % std::size(kLeaves);
+		is_nullable = leaf + 1 == std::size(kLeaves);
+		return kLeaves[leaf];
+	}
+
+	bool left = false;
+	bool right = false;
+	auto operand = randomPattern(rng, depth - 1, &left);
+	switch (rng() % 8) {
+		case 0:
+		case 1: {
+			operand += randomPattern(rng, depth - 1, &right);
+			is_nullable = left && right;
+			return operand;
+		}
+		case 2: {
+			operand = "(" + operand + "|" + randomPattern(rng, depth - 1, &right) + ")";
+			is_nullable = left || right;
+			return operand;
+		}
+		case 3: {
+			is_nullable = true;
+			return "(" + operand + "|)";
+		}
+		case 4:
+		case 5: {
+			const auto loop = rng() % 3;
+			is_nullable = left || loop != 1;
+			return "(" + operand + ")" + (loop == 2 || left ? "?" : loop == 1 ? "+" : "*");
+		}
+		case 6: {
+			const auto count = rng() % 3;
+			is_nullable = left || count == 0;
+			return "(" + operand + "){" + std::to_string(count) + "}";
+		}
+		default: {
+			const auto min = rng() % 3;
+			const auto bounded = left || rng() % 3 != 0;
+			is_nullable = left || min == 0;
+			return "(" + operand + "){" + std::to_string(min) + "," + (bounded ? std::to_string(min + rng() % 3) : "") + "}";
+		}
+	}
+}
+
+// Reference matcher for randomPattern: ECMAScript std::regex, whole string
+class Reference {
+public:
+	explicit Reference(const std::string& pattern)
+		: regex_{pattern}
+	{
+	}
+
+	bool accept(const std::string& s) const { return std::regex_match(s, regex_); }
+
+private:
+	std::regex regex_;
+};
+
+}  // namespace Test
@@ -0,0 +1,61 @@
+#include <random>
+#include <string>
+
+#include <automaton/lazy_automaton.hpp>
+#include <tests/common.hpp>
+
+
+namespace {
+
+// Any cache size gives the answers of the compiled DFA
+void sCacheSizes() {
+	std::mt19937 rng(42);
+	const auto words = Test::words("ab0", 6);
+	for (size_t i = 0; i < 100; ++i) {
+		const auto pattern = Test::randomPattern(rng, 4);
+		const auto matcher = Test::compile(pattern);
+		for (size_t capacity : {size_t{2}, size_t{3}, size_t{8}, LazyAutomaton::kDefaultCacheCapacity}) {
+			LazyAutomaton lazy{pattern, capacity};
+			for (auto&& s : words) {
+				Test::check(lazy.accept(s) == matcher.accept(s), pattern + " on \"" + s + "\" with cache " + std::to_string(capacity));
+			}
+		}
+	}
+}
+
+// A working set that fits the cache exactly never clears it
+void sExactFit() {
+	const std::string pattern = "(a|b)*a(a|b)(a|b)";
+	const auto words = Test::words("ab", 8);
+
+	LazyAutomaton unbounded{pattern};
+	for (auto&& s : words) {
+		unbounded.accept(s);
+	}
+
+	LazyAutomaton lazy{pattern, unbounded.cachedStates()};
+	for (auto&& s : words) {
+		lazy.accept(s);
+	}
+	Test::check(lazy.cacheClears() == 0, "cache of exactly the working set is not cleared");
+
+	LazyAutomaton small{pattern, unbounded.cachedStates() - 1};
+	for (auto&& s : words) {
+		small.accept(s);
+	}
+	Test::check(small.cacheClears() > 0, "cache below the working set is cleared");
+}
+
+void sInvalid() {
+	Test::throws([] { LazyAutomaton{"a", 1}; }, "cache of one state");
+}
+
+}  // namespace
+
+
+int main() {
+	sCacheSizes();
+	sExactFit();
+	sInvalid();
+	return Test::finish();
+}
@@ -0,0 +1,113 @@
+#include <random>
+#include <string>
+#include <vector>
+
+#include <parser/recursive_descent_parser.hpp>
+#include <tests/common.hpp>
+
+
+namespace {
+
+struct Case {
+	const char* pattern;
+	std::vector<std::string> accepted;
+	std::vector<std::string> rejected;
+};
+
+void sCheckCases(const std::vector<Case>& cases) {
+	for (auto&& [pattern, accepted, rejected] : cases) {
+		const auto matcher = Test::compile(pattern);
+		for (auto&& s : accepted) {
+			Test::check(matcher.accept(s), std::string{pattern} + " accepts \"" + s + "\"");
+		}
+		for (auto&& s : rejected) {
+			Test::check(!matcher.accept(s), std::string{pattern} + " rejects \"" + s + "\"");
+		}
+	}
+}
+
+void sClasses() {
+	sCheckCases({
+		{"[a-c]+", {"a", "abc", "cab"}, {"", "d", "abd"}},
+		{"[^a-c]", {"d", "0", "\n", "\xff"}, {"a", "c", ""}},
+		{"[]a]", {"]", "a"}, {"b", "[]"}},
+		{"[a-]", {"a", "-"}, {"b"}},
+		{"[\\d_]+", {"0_9", "_"}, {"a", ""}},
+		{"\\w\\W\\s\\S", {"a  b", "_-\tx"}, {"ab b", "a- "}},
+		{"[é-ë]", {"é", "ê", "ë"}, {"è", "ì", "e", "\xc3"}},
+		{"[^é]", {"a", "è", "\xe2\x82\xac"}, {"é", "\xc3"}},
+		{"[\\u{10000}-\\u{10FFFF}]", {"\xf0\x90\x80\x80", "\xf4\x8f\xbf\xbf"}, {"\xef\xbf\xbf", "a"}},
+	});
+}
+
+void sEscapes() {
+	sCheckCases({
+		{"\\x41\\x7a", {"Az"}, {"x41", "az"}},
+		{"\\xff\\x00", {std::string{"\xff\x00", 2}}, {"\xff"}},
+		{"\\u00e9|\\u{20AC}", {"é", "€"}, {"e", "\xe9"}},
+		{"\\n\\t\\r\\f\\v\\0", {std::string{"\n\t\r\f\v\0", 6}}, {"ntrfv0"}},
+		{"\\(\\)\\|\\*\\[\\\\", {"()|*[\\"}, {""}},
+		{"a.b", {"a.b"}, {"axb"}},
+		{"*a+", {"*a", "*aa"}, {"a"}},
+	});
+}
+
+void sRepetition() {
+	sCheckCases({
+		{"a{3}", {"aaa"}, {"aa", "aaaa"}},
+		{"a{2,}", {"aa", "aaaaaaa"}, {"a", ""}},
+		{"a{0,2}b", {"b", "ab", "aab"}, {"aaab"}},
+		{"(ab|c){1,2}", {"ab", "c", "abc", "cab"}, {"", "abcab"}},
+		{"a{0}b", {"b"}, {"ab"}},
+		{"(a{2}){2,3}", {"aaaa", "aaaaaa"}, {"aaa", "aaaaa", "aaaaaaaa"}},
+		{"[a-c]{2}\\d{1,2}", {"ab1", "cc12"}, {"a1", "ab123"}},
+	});
+}
+
+void sMalformed() {
+	for (auto pattern : {"(", ")", "a)", "[", "[b-a]", "a{2,1}", "a{1001}", "a{", "a{1", "a{x}", "\\", "\\x4", "\\xg0", "\\u{110000}", "\\uD800", "\\u12", "[é-a]", "[\\xff-é]"}) {
+		Test::throws([&] {
+			AbstractSyntaxTreeArena arena;
+			RecursiveDescentParser{}.parse(pattern, arena);
+		}, std::string{"parse rejects "} + pattern);
+	}
+}
+
+// Copies made by counted repetition are limited in total, nested counts multiply
+void sRepetitionSize() {
+	const auto parse = [](const std::string& pattern) {
+		AbstractSyntaxTreeArena arena;
+		RecursiveDescentParser{}.parse(pattern, arena);
+	};
+
+	Test::throws([&] { parse("((a{1000}){1000}){1000}"); }, "nested repetition beyond the budget");
+	Test::throws([&] { parse(Test::repeat("(a{1000}){1000}", 4)); }, "repetitions beyond the budget together");
+	parse("(a{1000}){1000}");
+}
+
+// Random patterns against std::regex on every short string
+void sReference() {
+	std::mt19937 rng(42);
+	const auto words = Test::words("ab0", 6);
+	for (size_t i = 0; i < 200; ++i) {
+		const auto pattern = Test::randomPattern(rng, 4);
+		const auto matcher = Test::compile(pattern);
+		const auto reference = Test::Reference{pattern};
+		for (auto&& s : words) {
+			Test::check(matcher.accept(s) == reference.accept(s), pattern + " on \"" + s + "\"");
+		}
+	}
+}
+
+}  // namespace
+
+
+int main() {
+	sClasses();
+	sEscapes();
+	sRepetition();
+	sMalformed();
+	sRepetitionSize();
+	sReference();
+	return Test::finish();
+}
@@ -0,0 +1,98 @@
+#include <random>
+#include <string>
+
+#include <automaton/product_automaton.hpp>
+#include <tests/common.hpp>
+
+
+namespace {
+
+using Operation = ProductAutomaton::Operation;
+
+constexpr Operation kOperations[] = {Operation::Intersection, Operation::Union, Operation::Difference, Operation::SymmetricDifference};
+
+bool sApply(Operation operation, bool in_a, bool in_b) {
+	switch (operation) {
+		case Operation::Intersection: return in_a && in_b;
+		case Operation::Union: return in_a || in_b;
+		case Operation::Difference: return in_a && !in_b;
+		case Operation::SymmetricDifference: return in_a != in_b;
+	}
+	return false;
+}
+
+// accept, witness and isEmpty against the operands on every short string
+void sReference() {
+	std::mt19937 rng(42);
+	const auto words = Test::words("ab0", 5);
+	for (size_t i = 0; i < 100; ++i) {
+		const auto pattern_a = Test::randomPattern(rng, 3);
+		const auto pattern_b = Test::randomPattern(rng, 3);
+		const auto a = Test::compile(pattern_a);
+		const auto b = Test::compile(pattern_b);
+		const auto name = pattern_a + " and " + pattern_b;
+
+		for (auto operation : kOperations) {
+			ProductAutomaton lazy{a, b, operation};
+
+			const std::string* shortest = nullptr;
+			for (auto&& s : words) {
+				const auto expected = sApply(operation, a.accept(s), b.accept(s));
+				Test::check(lazy.accept(s) == expected, name + " on \"" + s + "\"");
+				if (expected && !shortest) {
+					shortest = &s;
+				}
+			}
+
+			const auto witness = lazy.witness();
+			if (witness) {
+				Test::check(sApply(operation, a.accept(*witness), b.accept(*witness)), name + " witness is in the language");
+			}
+			// Witnesses may use bytes other than a, b and 0, so they can only be shorter
+			if (shortest) {
+				Test::check(witness && witness->size() <= shortest->size(), name + " witness is a shortest string");
+			}
+			Test::check(lazy.isEmpty() == !witness, name + " isEmpty agrees with witness");
+
+			ProductAutomaton eager{a, b, operation};
+			eager.materialize();
+			Test::check(eager.witness() == witness, name + " witness does not depend on materialization");
+		}
+	}
+}
+
+void sEquivalence() {
+	const auto a = Test::compile("(a|b)*abb");
+	const auto b = Test::compile("(a|b)*ab(b|bb*a(a|b)*abb)");
+	const auto c = Test::compile("(a|b)*abb(a|b)*");
+
+	Test::check(ProductAutomaton{a, a, Operation::SymmetricDifference}.isEmpty(), "an automaton is equivalent to itself");
+	Test::check(!ProductAutomaton{a, c, Operation::SymmetricDifference}.isEmpty(), "different languages are told apart");
+	Test::check(ProductAutomaton{a, c, Operation::Difference}.isEmpty(), "(a|b)*abb is included in (a|b)*abb(a|b)*");
+	Test::check(ProductAutomaton{c, a, Operation::Difference}.witness() == "abba", "least shortest string of c missing in a");
+	Test::check(ProductAutomaton{a, b, Operation::Difference}.isEmpty(), "(a|b)*abb is included in its rewrite");
+	Test::check(ProductAutomaton{a, a.complement(), Operation::Intersection}.isEmpty(), "nothing is in a and its complement");
+}
+
+// The double complement keeps the language but moves the sink off state 0
+void sSinks() {
+	const auto a = Test::compile("ab");
+	const auto b = Test::compile("(a|b|c)*c(a|b|c)(a|b|c)");
+	const auto sunk = a.complement().complement();
+
+	for (auto operation : kOperations) {
+		ProductAutomaton minimal{a, b, operation};
+		ProductAutomaton product{sunk, b, operation};
+		Test::check(product.materialize() == minimal.materialize(), "pairs with a sink that is not state 0 are not expanded");
+	}
+}
+
+}  // namespace
+
+
+int main() {
+	sReference();
+	sEquivalence();
+	sSinks();
+	return Test::finish();
+}
@@ -0,0 +1,111 @@
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <automaton/searcher.hpp>
+#include <tests/common.hpp>
+
+
+namespace {
+
+using Match = Searcher::Match;
+
+// Leftmost-longest by trying every substring with the anchored matcher
+std::optional<Match> sFind(const CompiledAutomaton& matcher, std::string_view text, size_t from) {
+	for (auto begin = from; begin <= text.size(); ++begin) {
+		for (auto end = text.size() + 1; end-- > begin;) {
+			if (matcher.accept(text.substr(begin, end - begin))) {
+				return Match{begin, end};
+			}
+		}
+	}
+	return std::nullopt;
+}
+
+std::vector<Match> sFindAll(const CompiledAutomaton& matcher, std::string_view text) {
+	std::vector<Match> result;
+	for (size_t from = 0; from <= text.size();) {
+		const auto match = sFind(matcher, text, from);
+		if (!match) {
+			break;
+		}
+		result.push_back(*match);
+		from = match->end > match->begin ? match->end : match->begin + 1;
+	}
+	return result;
+}
+
+void sReference() {
+	std::mt19937 rng(42);
+	const auto texts = Test::words("ab0", 5);
+	for (size_t i = 0; i < 100; ++i) {
+		const auto pattern = Test::randomPattern(rng, 3);
+		const auto matcher = Test::compile(pattern);
+		const Searcher searcher{matcher};
+
+		for (size_t t = 0; t < texts.size(); t += 7) {
+			const auto& text = texts[t];
+			for (size_t from = 0; from <= text.size() + 1; ++from) {
+				Test::check(searcher.find(text, from) == (from > text.size() ? std::nullopt : sFind(matcher, text, from)), pattern + " find in \"" + text + "\" from " + std::to_string(from));
+			}
+
+			const auto expected = sFindAll(matcher, text);
+			Test::check(searcher.findAll(text) == expected, pattern + " findAll in \"" + text + "\"");
+
+			std::vector<Match> lazy;
+			for (auto&& match : searcher.matches(text)) {
+				lazy.push_back(match);
+			}
+			Test::check(lazy == expected, pattern + " matches in \"" + text + "\"");
+		}
+	}
+}
+
+void sExamples() {
+	const Searcher searcher{Test::compile("ab|abcd|b+")};
+	Test::check(searcher.findAll("xabcdxabxbbb") == std::vector<Match>{{1, 5}, {6, 8}, {9, 12}}, "leftmost-longest matches");
+	Test::check(searcher.find("xabcdx", 2) == Match{2, 3}, "search from the middle of a match");
+	Test::check(!searcher.find("xyz"), "no match");
+
+	const Searcher empty{Test::compile("a*")};
+	Test::check(empty.findAll("ba") == std::vector<Match>{{0, 0}, {1, 2}, {2, 2}}, "empty matches advance by one byte");
+
+	const Searcher overlap{Test::compile("abcd|c")};
+	Test::check(overlap.find("abcd") == Match{0, 4}, "an earlier end does not hide a leftmost match");
+}
+
+// Every x is a match of x*y|x, a search that looks for y from each start is quadratic
+void sLinear() {
+	struct Case {
+		const char* pattern;
+		bool every_byte;  // Every x is a match, otherwise all of them are one match
+	};
+
+	for (auto [pattern, every_byte] : {Case{"x*y|x", true}, Case{"(x|y)*z|x", true}, Case{"x*", false}}) {
+		const Searcher searcher{Test::compile(pattern)};
+		for (size_t size : {size_t{1} << 10, size_t{1} << 14}) {
+			const auto text = Test::repeat("x", size);
+			auto matches = searcher.matches(text);
+			size_t count = 0;
+			for ([[maybe_unused]] auto&& match : matches) {
+				++count;
+			}
+
+			const auto name = std::string{pattern} + " on " + std::to_string(size) + " x";
+			Test::check(count == (every_byte ? size : 2), name + " match count");
+			Test::check(matches.steps() <= 8 * size, name + " takes at most 8 steps per byte, took " + std::to_string(matches.steps()));
+		}
+	}
+}
+
+}  // namespace
+
+
+int main() {
+	sReference();
+	sExamples();
+	sLinear();
+	return Test::finish();
+}
@@ -0,0 +1,133 @@
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <tests/common.hpp>
+
+
+namespace {
+
+// Image copied into 8-byte aligned storage, as fromImage requires
+class Image {
+public:
+	explicit Image(const CompiledAutomaton& automaton) {
+		std::stringstream out;
+		automaton.save(out);
+		const auto bytes = out.str();
+		words_.resize((bytes.size() + 7) / 8);
+		std::memcpy(words_.data(), bytes.data(), bytes.size());
+		size_ = bytes.size();
+	}
+
+	std::string_view view() const { return {reinterpret_cast<const char*>(words_.data()), size_}; }
+
+	// Flips a bit of byte offset
+	void corrupt(size_t offset) { reinterpret_cast<unsigned char*>(words_.data())[offset] ^= 1; }
+
+	uint32_t read(size_t offset) const {
+		uint32_t value;
+		std::memcpy(&value, view().data() + offset, sizeof(value));
+		return value;
+	}
+
+	void write(size_t offset, uint32_t value) { std::memcpy(reinterpret_cast<char*>(words_.data()) + offset, &value, sizeof(value)); }
+
+private:
+	std::vector<uint64_t> words_;
+	size_t size_ = 0;
+};
+
+bool sSamePatterns(const CompiledAutomaton& a, const CompiledAutomaton& b, std::string_view s) {
+	const auto x = a.match(s);
+	const auto y = b.match(s);
+	return std::equal(x.begin(), x.end(), y.begin(), y.end());
+}
+
+void sRoundTrip() {
+	std::mt19937 rng(42);
+	const auto words = Test::words("ab0", 5);
+	for (size_t i = 0; i < 100; ++i) {
+		const auto pattern = Test::randomPattern(rng, 4);
+		const auto built = Test::compile(pattern);
+		const Image image{built};
+
+		for (auto verify : {true, false}) {
+			const auto loaded = CompiledAutomaton::fromImage(image.view(), {}, verify);
+			Test::check(loaded.stateCount() == built.stateCount() && loaded.classCount() == built.classCount(), pattern + " keeps its shape");
+			for (auto&& s : words) {
+				Test::check(loaded.accept(s) == built.accept(s), pattern + " on \"" + s + "\" after a round trip");
+			}
+		}
+	}
+}
+
+void sPatternsAndFiles() {
+	auto dfa = DeterministicFiniteAutomaton{std::vector<std::string>{"if", "[a-z]+", "[0-9]+", "i[a-z]*"}};
+	dfa.minimize();
+	const auto built = dfa.compile();
+
+	const auto path = (std::filesystem::temp_directory_path() / "lab01_test_serialization.dfa").string();
+	{
+		std::ofstream out{path, std::ios::binary};
+		built.save(out);
+	}
+
+	const auto loaded = CompiledAutomaton::load(path);
+	for (auto s : {"if", "in", "x", "42", "", "i1", "iffy"}) {
+		Test::check(sSamePatterns(built, loaded, s), std::string{"accept patterns of \""} + s + "\" survive a file round trip");
+	}
+
+	std::filesystem::remove(path);
+}
+
+void sMalformed() {
+	const auto built = Test::compile("(a|b)*abb");
+	const Image image{built};
+
+	Test::throws([&] { CompiledAutomaton::fromImage(image.view().substr(0, 32)); }, "truncated header");
+	Test::throws([&] { CompiledAutomaton::fromImage(image.view().substr(0, image.view().size() - 1)); }, "truncated image");
+
+	for (size_t offset : {size_t{0}, size_t{8}, image.view().size() - 1}) {
+		auto corrupted = image;
+		corrupted.corrupt(offset);
+		Test::throws([&] { CompiledAutomaton::fromImage(corrupted.view()); }, "corrupted byte " + std::to_string(offset));
+	}
+}
+
+// Offsets past the accept patterns must not load even without verification
+void sUnverifiedOffsets() {
+	auto dfa = DeterministicFiniteAutomaton{std::vector<std::string>{"a", "b+"}};
+	dfa.minimize();
+	const Image image{dfa.compile()};
+
+	// Header fields and section layout of the format, sections are 64-byte aligned
+	const auto align = [](size_t offset) { return (offset + 63) / 64 * 64; };
+	const size_t states = image.read(32);
+	const size_t classes = image.read(36);
+	const auto accept_offsets = align(align(align(64 + 256) + states * classes * 4) + (states + 63) / 64 * 8);
+
+	auto past_end = image;
+	past_end.write(accept_offsets + states * 4, image.read(44) + 1);
+	Test::throws([&] { CompiledAutomaton::fromImage(past_end.view(), {}, false); }, "last accept offset past the patterns");
+
+	auto unsorted = image;
+	unsorted.write(accept_offsets + 4, image.read(44) + 1);
+	Test::throws([&] { CompiledAutomaton::fromImage(unsorted.view(), {}, false); }, "decreasing accept offsets");
+}
+
+}  // namespace
+
+
+int main() {
+	sRoundTrip();
+	sPatternsAndFiles();
+	sMalformed();
+	sUnverifiedOffsets();
+	return Test::finish();
+}
@@ -0,0 +1,43 @@
+#include <string>
+#include <vector>
+
+#include <automaton/static_automaton.hpp>
+#include <tests/common.hpp>
+
+
+namespace {
+
+// StaticAutomaton and the run-time pipeline share the grammar, they must agree on every text
+template <FixedString Pattern>
+void sCompare(const std::vector<std::string>& texts) {
+	const std::string pattern{Pattern.view()};
+	const auto matcher = Test::compile(pattern);
+	for (auto&& s : texts) {
+		Test::check(StaticAutomaton<Pattern>::accept(s) == matcher.accept(s), pattern + " on \"" + s + "\"");
+	}
+}
+
+template <FixedString... Patterns>
+void sCorpus(const std::vector<std::string>& texts) {
+	(sCompare<Patterns>(texts), ...);
+}
+
+}  // namespace
+
+
+int main() {
+	auto texts = Test::words("ab0c", 5);
+	for (auto s : {"é", "ê", "è", "€", "\xc3", "\xff", "\xf0\x90\x80\x80", "a.b", "*a", "x@y.com", "]", "-", "_ \t"}) {
+		texts.emplace_back(s);
+	}
+
+	sCorpus<
+		"", "a", "ab|c", "(a|b)*abb", "(a|b)*ab(b|bb*a(a|b)*abb)", "a*b+c?", "(|a)(b|)", "()", "(a*)*", "x*y|x",
+		"[a-c]+", "[^a-c]", "[]a]", "[a-]", "[\\d_]+", "\\w\\W\\s\\S", "\\w+@\\w+\\.com", "[^\\x00-\\xff]",
+		"[é-ë]", "[^é]", "[\\u{10000}-\\u{10FFFF}]", "\\u00e9|\\u{20AC}", "é+", "\\xff\\x00|\\x41", "a.b", "*a+",
+		"a{3}", "a{2,}", "a{0,2}b", "(ab|c){1,2}", "a{0}b", "(a{2}){2,3}", "((ab|c){1,2}0?){2}", "[a-c]{2}\\d{1,2}",
+		"(a|b{2,3}){0,}c", "((a|)b*){2,4}"
+	>(texts);
+
+	return Test::finish();
+}
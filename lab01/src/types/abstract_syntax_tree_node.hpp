@@ -1,4 +1,83 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
 #include <types/binary_tree_node.hpp>
+#include <types/common.hpp>
+
+
+enum class NodeKind : uint8_t {
+	// Leaves
+	Empty,      // matches the empty string
+	Byte,       // matches byte
+	Class,      // matches any byte of a set kept in the arena
+	EndMarker,  // '#' of the augmented expression, matches nothing
+	// Operators
+	Or,
+	Cat,
+	Star,
+	Plus,
+	Optional,
+};
+
+// Kinds are kept apart from bytes, so every byte value can be matched
+struct NodeLabel {
+	NodeKind kind = NodeKind::Empty;
+	char byte = '\0';
+};
+
+using AbstractSyntaxTreeNode = BinaryTreeNode<NodeLabel>;
+
+
+// A class is a single leaf whose bytes are kept aside, so it stays one position
+class AbstractSyntaxTreeArena : public BinaryTreeArena<NodeLabel> {
+public:
+	NodeId createClass(const ByteSet& bytes) {
+		const auto id = create({NodeKind::Class});
+		classes_.emplace(id, bytes);
+		return id;
+	}
+
+	// Bytes matched by a leaf, empty for Empty and EndMarker
+	ByteSet bytes(NodeId id) const {
+		const auto& label = (*this)[id].data;
+
+		ByteSet result;
+		if (label.kind == NodeKind::Class) {
+			result = classes_.at(id);
+		} else if (label.kind == NodeKind::Byte) {
+			result.set(static_cast<unsigned char>(label.byte));
+		}
+		return result;
+	}
+
+	// Copies the subtree with fresh nodes, returns the new root
+	NodeId clone(NodeId root) {
+		std::vector<NodeId> order = {root};  // parents before children
+		for (size_t i = 0; i < order.size(); ++i) {
+			for (auto child : {(*this)[order[i]].left, (*this)[order[i]].right}) {
+				if (child != kNoNode) {
+					order.push_back(child);
+				}
+			}
+		}
+
+		UMap<NodeId, NodeId> copies;
+		const auto copy = [&](NodeId id) { return id == kNoNode ? kNoNode : copies.at(id); };
+		for (auto it = order.rbegin(); it != order.rend(); ++it) {
+			const auto node = (*this)[*it];
+			copies[*it] = node.data.kind == NodeKind::Class ? createClass(classes_.at(*it)) : create(node.data, copy(node.left), copy(node.right));
+		}
+
+		return copies.at(root);
+	}
 
+	void reset() {
+		BinaryTreeArena::reset();
+		classes_.clear();
+	}
 
-using AbstractSyntaxTreeNode = BinaryTreeNode<char>;
+private:
+	UMap<NodeId, ByteSet> classes_;
+};
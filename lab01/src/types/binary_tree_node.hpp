@@ -1,30 +1,65 @@
 #pragma once
 
-#include <functional>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+
+using NodeId = uint32_t;
+
+constexpr NodeId kNoNode = UINT32_MAX;
 
 
 template <typename T>
 struct BinaryTreeNode {
 	T data = T{};
-	BinaryTreeNode* left = nullptr;
-	BinaryTreeNode* right = nullptr;
+	NodeId left = kNoNode;
+	NodeId right = kNoNode;
 
 	bool isLeaf() const {
-		return !left && !right;
+		return left == kNoNode && right == kNoNode;
+	}
+};
+
+
+// Owns all nodes of one or more trees in contiguous storage, children are
+// referenced by index. Trees are freed all at once by reset or destruction.
+template <typename T>
+class BinaryTreeArena {
+public:
+	using Node = BinaryTreeNode<T>;
+
+	NodeId create(T data, NodeId left = kNoNode, NodeId right = kNoNode) {
+		nodes_.push_back(Node{std::move(data), left, right});
+		return static_cast<NodeId>(nodes_.size() - 1);
 	}
 
-	using Callback = std::function<void(BinaryTreeNode*)>;
+	Node& operator[](NodeId id) { return nodes_[id]; }
+	const Node& operator[](NodeId id) const { return nodes_[id]; }
 
-	void applyToChildren(const Callback& callback) {
-		for (auto child : {left, right}) {
-			if (child) {
-				callback(child);
+	size_t size() const { return nodes_.size(); }
+
+	// Number of nodes in the tree of root
+	size_t size(NodeId root) const {
+		size_t result = 0;
+		std::vector<NodeId> stack = {root};
+		while (!stack.empty()) {
+			const auto& node = nodes_[stack.back()];
+			stack.pop_back();
+			++result;
+			for (auto child : {node.left, node.right}) {
+				if (child != kNoNode) {
+					stack.push_back(child);
+				}
 			}
 		}
+		return result;
 	}
 
-	static void clear(BinaryTreeNode* node) {
-		node->applyToChildren(clear);
-		delete node;
-	}
+	// Frees every node, capacity is kept for the next tree
+	void reset() { nodes_.clear(); }
+
+private:
+	std::vector<Node> nodes_;
 };
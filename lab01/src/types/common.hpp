@@ -1,5 +1,6 @@
 #pragma once
 
+#include <bitset>
 #include <set>
 #include <string>
 #include <unordered_map>
@@ -8,8 +9,8 @@
 template <typename T>
 using Set = std::set<T>;
 
-template <typename T, typename U>
-using UMap = std::unordered_map<T, U>;
+template <typename T, typename U, typename Hash = std::hash<T>>
+using UMap = std::unordered_map<T, U, Hash>;
 
 using State = std::string;
 using Symbol = char;
@@ -18,3 +19,10 @@ using States = Set<State>;
 using Alphabet = Set<Symbol>;
 
 using Transitions = UMap<State, UMap<Symbol, States>>;
+using EpsilonTransitions = UMap<State, States>;
+
+using ByteSet = std::bitset<256>;
+
+// Indices of the patterns accepted in a state, the smallest one has the highest priority
+using PatternIds = Set<size_t>;
+using AcceptPatterns = UMap<State, PatternIds>;
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+
+// Set of AST positions stored as a sparse bitset: only non-zero 64-bit words
+// are kept, sorted by word index, so memory follows the number of elements
+// rather than the largest position.
+class PositionSet {
+public:
+	class Iterator {
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = size_t;
+		using difference_type = std::ptrdiff_t;
+		using pointer = const size_t*;
+		using reference = size_t;
+
+		Iterator() = default;
+
+		Iterator(const PositionSet* set, size_t word)
+			: set_{set}
+			, word_{word}
+			, bits_{word < set->words_.size() ? set->words_[word].bits : 0}
+		{
+		}
+
+		size_t operator*() const {
+			return size_t{set_->words_[word_].index} * 64 + static_cast<size_t>(std::countr_zero(bits_));
+		}
+
+		Iterator& operator++() {
+			bits_ &= bits_ - 1;
+			if (!bits_ && ++word_ < set_->words_.size()) {
+				bits_ = set_->words_[word_].bits;
+			}
+			return *this;
+		}
+
+		Iterator operator++(int) {
+			auto copy = *this;
+			++*this;
+			return copy;
+		}
+
+		bool operator==(const Iterator& other) const {
+			return word_ == other.word_ && bits_ == other.bits_;
+		}
+
+	private:
+		const PositionSet* set_ = nullptr;
+		size_t word_ = 0;
+		uint64_t bits_ = 0;
+	};
+
+	// Amortized O(1) when positions are inserted in increasing order
+	void insert(size_t position) {
+		const auto index = static_cast<uint32_t>(position / 64);
+		const auto bit = uint64_t{1} << (position % 64);
+
+		if (words_.empty() || words_.back().index < index) {
+			words_.push_back({bit, index});
+			return;
+		}
+
+		const auto it = sFind_(words_, index);
+		if (it->index == index) {
+			it->bits |= bit;
+		} else {
+			words_.insert(it, {bit, index});
+		}
+	}
+
+	bool contains(size_t position) const {
+		const auto index = static_cast<uint32_t>(position / 64);
+		const auto it = sFind_(words_, index);
+		return it != words_.end() && it->index == index && (it->bits >> (position % 64) & 1);
+	}
+
+	bool empty() const {
+		return words_.empty();
+	}
+
+	size_t size() const {
+		size_t result = 0;
+		for (auto&& word : words_) {
+			result += static_cast<size_t>(std::popcount(word.bits));
+		}
+		return result;
+	}
+
+	// Linear merge of the word lists
+	PositionSet& operator|=(const PositionSet& other) {
+		if (other.empty()) {
+			return *this;
+		}
+		if (empty() || words_.back().index < other.words_.front().index) {
+			words_.insert(words_.end(), other.words_.begin(), other.words_.end());
+			return *this;
+		}
+
+		std::vector<Word_> result;
+		result.reserve(words_.size() + other.words_.size());
+
+		auto a = words_.begin();
+		auto b = other.words_.begin();
+		while (a != words_.end() || b != other.words_.end()) {
+			if (b == other.words_.end() || (a != words_.end() && a->index < b->index)) {
+				result.push_back(*a++);
+			} else if (a == words_.end() || b->index < a->index) {
+				result.push_back(*b++);
+			} else {
+				result.push_back({a++->bits | b->bits, b->index});
+				++b;
+			}
+		}
+
+		words_ = std::move(result);
+		return *this;
+	}
+
+	friend PositionSet operator|(PositionSet a, const PositionSet& b) {
+		a |= b;
+		return a;
+	}
+
+	Iterator begin() const { return Iterator{this, 0}; }
+	Iterator end() const { return Iterator{this, words_.size()}; }
+
+private:
+	struct Word_ {
+		uint64_t bits;
+		uint32_t index;
+	};
+
+	std::vector<Word_> words_;  // non-zero, sorted by index
+
+	template <typename Words>
+	static auto sFind_(Words& words, uint32_t index) -> decltype(words.begin()) {
+		return std::lower_bound(words.begin(), words.end(), index, [](auto&& word, auto value) { return word.index < value; });
+	}
+};
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+
+namespace HashUtils {
+
+inline size_t combine(size_t seed, size_t value) {
+	return seed ^ (value + 0x9e3779b97f4a7c15 + (seed << 6) + (seed >> 2));
+}
+
+template <typename T>
+struct VectorHash {
+	size_t operator()(const std::vector<T>& vector) const noexcept {
+		auto seed = vector.size();
+		for (auto&& x : vector) {
+			seed = combine(seed, std::hash<T>{}(x));
+		}
+		return seed;
+	}
+};
+
+}  // namespace HashUtils
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+
+// Minimal streaming JSON writer: commas and nesting are tracked, values are
+// escaped, output is indented by two spaces per level
+class JsonWriter {
+public:
+	JsonWriter& beginObject() { return open_('{'); }
+	JsonWriter& endObject() { return close_('}'); }
+	JsonWriter& beginArray() { return open_('['); }
+	JsonWriter& endArray() { return close_(']'); }
+
+	// Name of the next value inside an object
+	JsonWriter& key(std::string_view name) {
+		separate_();
+		quote_(name);
+		json_ += ": ";
+		after_key_ = true;
+		return *this;
+	}
+
+	JsonWriter& value(std::string_view s) {
+		separate_();
+		quote_(s);
+		return *this;
+	}
+
+	JsonWriter& value(const char* s) { return value(std::string_view{s}); }
+
+	JsonWriter& value(bool b) {
+		separate_();
+		json_ += b ? "true" : "false";
+		return *this;
+	}
+
+	// Infinities and NaN have no JSON form and are written as null
+	JsonWriter& value(double x) {
+		separate_();
+		if (!std::isfinite(x)) {
+			json_ += "null";
+			return *this;
+		}
+		char buffer[32];
+		std::snprintf(buffer, sizeof(buffer), "%.6g", x);
+		json_ += buffer;
+		return *this;
+	}
+
+	template <typename T>
+		requires(std::is_integral_v<T> && !std::is_same_v<T, bool>)
+	JsonWriter& value(T x) {
+		separate_();
+		json_ += std::to_string(x);
+		return *this;
+	}
+
+	const std::string& str() const { return json_; }
+
+private:
+	std::string json_;
+	std::vector<bool> has_items_;  // per open level
+	bool after_key_ = false;
+
+	void separate_() {
+		if (after_key_) {
+			after_key_ = false;
+			return;
+		}
+		if (!has_items_.empty()) {
+			json_ += has_items_.back() ? ",\n" : "\n";
+			has_items_.back() = true;
+			json_.append(2 * has_items_.size(), ' ');
+		}
+	}
+
+	JsonWriter& open_(char bracket) {
+		separate_();
+		json_ += bracket;
+		has_items_.push_back(false);
+		return *this;
+	}
+
+	JsonWriter& close_(char bracket) {
+		const auto had_items = has_items_.back();
+		has_items_.pop_back();
+		if (had_items) {
+			json_ += "\n";
+			json_.append(2 * has_items_.size(), ' ');
+		}
+		json_ += bracket;
+		return *this;
+	}
+
+	void quote_(std::string_view s) {
+		json_ += '"';
+		for (auto c : s) {
+			switch (c) {
+				case '"': json_ += "\\\""; break;
+				case '\\': json_ += "\\\\"; break;
+				case '\n': json_ += "\\n"; break;
+				case '\t': json_ += "\\t"; break;
+				case '\r': json_ += "\\r"; break;
+				default:
+					if (static_cast<unsigned char>(c) < 0x20) {
+						char buffer[8];
+						std::snprintf(buffer, sizeof(buffer), "\\u%04x", static_cast<unsigned>(c));
+						json_ += buffer;
+					} else {
+						json_ += c;
+					}
+			}
+		}
+		json_ += '"';
+	}
+};
@@ -0,0 +1,44 @@
+#include <utils/mapped_file.hpp>
+
+#include <cerrno>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+MappedFile::MappedFile(const std::string& path, Access access /* = Access::Sequential */) {
+	const auto fd = ::open(path.c_str(), O_RDONLY);
+	if (fd == -1) {
+		throw std::system_error(errno, std::generic_category(), "[MappedFile::MappedFile] Cannot open \"" + path + "\"");
+	}
+
+	struct stat st = {};
+	if (::fstat(fd, &st) == -1) {
+		const auto error = errno;
+		::close(fd);
+		throw std::system_error(error, std::generic_category(), "[MappedFile::MappedFile] Cannot stat \"" + path + "\"");
+	}
+
+	size_ = static_cast<size_t>(st.st_size);
+	if (size_ != 0) {
+		auto* address = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (address == MAP_FAILED) {
+			const auto error = errno;
+			::close(fd);
+			throw std::system_error(error, std::generic_category(), "[MappedFile::MappedFile] Cannot map \"" + path + "\"");
+		}
+		::madvise(address, size_, access == Access::Sequential ? MADV_SEQUENTIAL : MADV_RANDOM);
+		data_ = static_cast<const char*>(address);
+	}
+
+	::close(fd);
+}
+
+MappedFile::~MappedFile() {
+	if (data_) {
+		::munmap(const_cast<char*>(data_), size_);
+	}
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+
+// Read-only memory mapping of a whole file
+class MappedFile {
+public:
+	// Expected access pattern, passed to the kernel as a read-ahead hint
+	enum class Access { Sequential, Random };
+
+	// Throws std::system_error if file cannot be opened or mapped
+	explicit MappedFile(const std::string& path, Access access = Access::Sequential);
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	const char* data() const noexcept { return data_; }
+	size_t size() const noexcept { return size_; }
+	std::string_view view() const noexcept { return {data_, size_}; }
+
+private:
+	const char* data_ = nullptr;
+	size_t size_ = 0;
+};
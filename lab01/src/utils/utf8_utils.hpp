@@ -0,0 +1,169 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+
+namespace Utf8Utils {
+
+constexpr char32_t kMaxCodepoint = 0x10FFFF;
+constexpr char32_t kSurrogateFirst = 0xD800;
+constexpr char32_t kSurrogateLast = 0xDFFF;
+
+// Largest codepoint encoded with i + 1 bytes
+constexpr char32_t kMaxOfLength[] = {0x7F, 0x7FF, 0xFFFF};
+
+struct ByteRange {
+	uint8_t first;
+	uint8_t last;
+};
+
+// One byte range per encoded byte (1 to 4 ranges)
+using Sequence = std::vector<ByteRange>;
+
+// Everything here is constexpr so that StaticAutomaton can parse patterns at compile time
+
+constexpr bool isValid(char32_t codepoint) {
+	return codepoint <= kMaxCodepoint && (codepoint < kSurrogateFirst || codepoint > kSurrogateLast);
+}
+
+// Codepoint must be valid
+constexpr std::string encode(char32_t codepoint) {
+	std::string result;
+	if (codepoint <= 0x7F) {
+		result += static_cast<char>(codepoint);
+	} else if (codepoint <= 0x7FF) {
+		result += static_cast<char>(0xC0 | (codepoint >> 6));
+		result += static_cast<char>(0x80 | (codepoint & 0x3F));
+	} else if (codepoint <= 0xFFFF) {
+		result += static_cast<char>(0xE0 | (codepoint >> 12));
+		result += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+		result += static_cast<char>(0x80 | (codepoint & 0x3F));
+	} else {
+		result += static_cast<char>(0xF0 | (codepoint >> 18));
+		result += static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F));
+		result += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+		result += static_cast<char>(0x80 | (codepoint & 0x3F));
+	}
+	return result;
+}
+
+// Decodes the first codepoint of bytes, returns the number of bytes used
+// or 0 if bytes do not start with a well-formed sequence
+constexpr size_t decode(std::string_view bytes, char32_t& codepoint) {
+	if (bytes.empty()) {
+		return 0;
+	}
+
+	const auto lead = static_cast<unsigned char>(bytes[0]);
+	size_t size = 0;
+	if (lead <= 0x7F) {
+		codepoint = lead;
+		return 1;
+	} else if (lead >= 0xC2 && lead <= 0xDF) {
+		size = 2;
+		codepoint = lead & 0x1F;
+	} else if (lead >= 0xE0 && lead <= 0xEF) {
+		size = 3;
+		codepoint = lead & 0x0F;
+	} else if (lead >= 0xF0 && lead <= 0xF4) {
+		size = 4;
+		codepoint = lead & 0x07;
+	} else {
+		return 0;
+	}
+
+	if (bytes.size() < size) {
+		return 0;
+	}
+
+	for (size_t i = 1; i < size; ++i) {
+		const auto byte = static_cast<unsigned char>(bytes[i]);
+		if ((byte & 0xC0) != 0x80) {
+			return 0;
+		}
+		codepoint = (codepoint << 6) | (byte & 0x3F);
+	}
+
+	// Overlong forms, surrogates and values above kMaxCodepoint
+	if (codepoint <= kMaxOfLength[size - 2] || !isValid(codepoint)) {
+		return 0;
+	}
+
+	return size;
+}
+
+// Byte range sequences matching exactly the encodings of [first, last],
+// surrogates are skipped. At most a few sequences per range, so a class
+// of codepoints becomes a handful of byte-level positions.
+// The range is split until both ends share the encoding length and every
+// continuation byte below the first differing one spans 80-BF
+constexpr std::vector<Sequence> sequences(char32_t first, char32_t last) {
+	std::vector<Sequence> result;
+
+	std::vector<std::pair<char32_t, char32_t>> stack = {{first, last}};
+	while (!stack.empty()) {
+		auto [start, end] = stack.back();
+		stack.pop_back();
+
+		auto split = [&](char32_t middle) {
+			stack.emplace_back(middle + 1, end);
+			end = middle;
+		};
+
+		while (true) {
+			if (start <= kSurrogateLast && end >= kSurrogateFirst) {
+				stack.emplace_back(kSurrogateLast + 1, end);
+				end = kSurrogateFirst - 1;
+			}
+			if (start > end || start > kMaxCodepoint) {
+				break;
+			}
+			end = std::min(end, kMaxCodepoint);
+
+			auto done = true;
+			for (auto max : kMaxOfLength) {
+				if (start <= max && max < end) {
+					split(max);
+					done = false;
+					break;
+				}
+			}
+
+			for (size_t i = 1; done && i < 4; ++i) {
+				const char32_t mask = (char32_t{1} << (6 * i)) - 1;
+				if ((start & ~mask) != (end & ~mask)) {
+					if ((start & mask) != 0) {
+						split(start | mask);
+						done = false;
+					} else if ((end & mask) != mask) {
+						split((end & ~mask) - 1);
+						done = false;
+					}
+				}
+			}
+
+			if (!done) {
+				continue;
+			}
+
+			const auto from = encode(start);
+			const auto to = encode(end);
+			Sequence sequence;
+			for (size_t i = 0; i < from.size(); ++i) {
+				sequence.push_back({static_cast<uint8_t>(from[i]), static_cast<uint8_t>(to[i])});
+			}
+			result.push_back(std::move(sequence));
+			break;
+		}
+	}
+
+	return result;
+}
+
+}  // namespace Utf8Utils